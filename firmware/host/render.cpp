@@ -0,0 +1,662 @@
+/**
+ * @file render.cpp
+ * @brief Offline renderer and benchmark for the pico-303 SynthEngine.
+ *
+ * Replays an event script through the same SynthEngine the firmware runs,
+ * writes a 16-bit stereo WAV and reports the cost of each stage in ns/sample.
+ * With --compare, the render is checked against a reference WAV so DSP
+ * optimizations can be verified to keep the sound the same. --kernels picks
+ * the float or fixed-point kernel set, --kernel-bench runs the firmware's
+ * startup KernelBench and prints ns per block for both sets. --osc picks the
+ * oscillator's band-limiting method; --osc-test compares both methods' aliasing
+ * and cost on single oscillators. --tanh-test checks the output clipper's tanh
+ * approximations against std::tanh and fails above their documented bounds. --psram gives the engine a PSRAM arena (host
+ * memory, marked external), so the delay line runs through its staged batches;
+ * --delay-ms sets the line length (default 1000 ms, 500 ms above 48 kHz in
+ * SRAM, as AUDIO_MAX_DELAY_MS in the sketch).
+ *
+ * Script format, one event per line ('#' starts a comment):
+ *   <time_ms> on <pitch> <velocity> [channel]
+ *   <time_ms> off <pitch> [channel]
+ *   <time_ms> cc <number> <value> [channel]
+ *   <time_ms> nrpn <number> <value> [channel]   (14-bit value, 0-16383)
+ *   <time_ms> clock <bpm> <until_ms> [jitter_ms]
+ *                                      (24 ppqn ticks from time_ms to until_ms, each
+ *                                      delayed by a pseudo-random 0 ... jitter_ms)
+ *   <time_ms> start | continue | stop
+ *   <time_ms> spp <sixteenths>         (song position pointer)
+ *   <time_ms> pattern <step> ...       (sequencer pattern, up to 16 steps: a MIDI
+ *                                      note with optional a = accent, s = slide
+ *                                      suffixes, e.g. 36as, or - for a rest)
+ *   <time_ms> seq start | stop | internal | clock | tempo <bpm>
+ *   <time_ms> end                      (render length, default: last event + 2 s)
+ * The channel defaults to 1; with --voices N, channel c plays voice (c - 1) % N.
+ */
+
+#include "SynthEngine.h"
+#include "KernelBench.h"
+#include "OutputStage.h"
+#include "FixedPoint.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+namespace {
+
+struct ScriptEvent {
+  double timeMs;
+  enum Type { ON, OFF, CC, NRPN, CLOCK, START, CONTINUE, STOP, SPP, PATTERN, SEQ } type;
+  uint8_t data1;
+  uint8_t data2;
+  uint8_t channel;
+  uint8_t data3 = 0;  // NRPN value LSB
+  float value = 0.0f;  // SEQ tempo
+};
+
+// SEQ commands (ScriptEvent::data1)
+enum SeqOp : uint8_t { SEQ_START, SEQ_STOP, SEQ_INTERNAL, SEQ_CLOCK, SEQ_TEMPO };
+
+// Patterns of the script (ScriptEvent::data1 of PATTERN events)
+std::vector<StepSequencer::Pattern> scriptPatterns;
+
+const char* const kStageNames[SynthEngine::STAGE_COUNT] = {
+  "env", "osc", "filter", "vca", "dist", "delay", "output"
+};
+
+uint32_t nowNanos() {
+  using namespace std::chrono;
+  return (uint32_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool loadScript(const char* path, std::vector<ScriptEvent>& events, double& endMs) {
+  std::ifstream in(path);
+  if (!in) {
+    fprintf(stderr, "Cannot open script %s\n", path);
+    return false;
+  }
+
+  double lastMs = 0.0;
+  endMs = -1.0;
+  std::string line;
+  int lineNo = 0;
+  while (std::getline(in, line)) {
+    lineNo++;
+    line = line.substr(0, line.find('#'));
+    std::istringstream ss(line);
+    double t;
+    std::string op;
+    if (!(ss >> t)) continue;  // Blank or comment line
+    if (!(ss >> op)) {
+      fprintf(stderr, "%s:%d: missing event type\n", path, lineNo);
+      return false;
+    }
+
+    int a = 0, b = 0, ch = 1;
+    if (op == "on" && (ss >> a >> b)) {
+      ss >> ch;
+      events.push_back({t, ScriptEvent::ON, (uint8_t)a, (uint8_t)b, (uint8_t)ch});
+    } else if (op == "off" && (ss >> a)) {
+      ss >> ch;
+      events.push_back({t, ScriptEvent::OFF, (uint8_t)a, 0, (uint8_t)ch});
+    } else if (op == "cc" && (ss >> a >> b)) {
+      ss >> ch;
+      events.push_back({t, ScriptEvent::CC, (uint8_t)a, (uint8_t)b, (uint8_t)ch});
+    } else if (op == "nrpn" && (ss >> a >> b)) {
+      ss >> ch;
+      b = std::clamp(b, 0, 16383);
+      events.push_back({t, ScriptEvent::NRPN, (uint8_t)a, (uint8_t)(b >> 7), (uint8_t)ch, (uint8_t)(b & 0x7F)});
+    } else if (op == "clock") {
+      double bpm, untilMs, jitterMs = 0.0;
+      if (!(ss >> bpm >> untilMs) || bpm <= 0.0) {
+        fprintf(stderr, "%s:%d: expected 'clock <bpm> <until_ms> [jitter_ms]'\n", path, lineNo);
+        return false;
+      }
+      ss >> jitterMs;
+      const double tickMs = 60000.0 / (bpm * 24.0);
+      uint32_t seed = (uint32_t)lineNo;  // Same jitter on every run
+      for (double tt = t; tt < untilMs; tt += tickMs) {
+        seed = seed * 1664525u + 1013904223u;
+        events.push_back({tt + jitterMs * (seed >> 8) * (1.0 / 16777216.0), ScriptEvent::CLOCK, 0, 0, 0});
+      }
+      t = untilMs;
+    } else if (op == "start" || op == "continue" || op == "stop") {
+      ScriptEvent::Type type = op == "start" ? ScriptEvent::START
+                             : op == "continue" ? ScriptEvent::CONTINUE : ScriptEvent::STOP;
+      events.push_back({t, type, 0, 0, 0});
+    } else if (op == "spp" && (ss >> a)) {
+      events.push_back({t, ScriptEvent::SPP, (uint8_t)(a & 0x7F), (uint8_t)((a >> 7) & 0x7F), 0});
+    } else if (op == "pattern") {
+      StepSequencer::Pattern pattern;
+      int n = 0;
+      std::string token;
+      while (n < StepSequencer::kSteps && ss >> token) {
+        StepSequencer::Step& step = pattern.steps[n++];
+        if (token == "-") continue;
+        size_t used = 0;
+        step.pitch = (uint8_t)std::clamp(std::stoi(token, &used), 0, 127);
+        step.flags = StepSequencer::GATE;
+        for (char c : token.substr(used)) {
+          if (c == 'a') step.flags |= StepSequencer::ACCENT;
+          if (c == 's') step.flags |= StepSequencer::SLIDE;
+        }
+      }
+      if (n == 0) {
+        fprintf(stderr, "%s:%d: empty pattern\n", path, lineNo);
+        return false;
+      }
+      pattern.length = (uint8_t)n;
+      scriptPatterns.push_back(pattern);
+      events.push_back({t, ScriptEvent::PATTERN, (uint8_t)(scriptPatterns.size() - 1), 0, 0});
+    } else if (op == "seq") {
+      std::string cmd;
+      float bpm = 0.0f;
+      ss >> cmd;
+      ScriptEvent ev = {t, ScriptEvent::SEQ, SEQ_START, 0, 0};
+      if (cmd == "stop") ev.data1 = SEQ_STOP;
+      else if (cmd == "internal") ev.data1 = SEQ_INTERNAL;
+      else if (cmd == "clock") ev.data1 = SEQ_CLOCK;
+      else if (cmd == "tempo" && (ss >> bpm)) ev.data1 = SEQ_TEMPO;
+      else if (cmd != "start") {
+        fprintf(stderr, "%s:%d: expected 'seq start|stop|internal|clock|tempo <bpm>'\n", path, lineNo);
+        return false;
+      }
+      ev.value = bpm;
+      events.push_back(ev);
+    } else if (op == "end") {
+      endMs = t;
+    } else {
+      fprintf(stderr, "%s:%d: bad event '%s'\n", path, lineNo, line.c_str());
+      return false;
+    }
+    lastMs = std::max(lastMs, t);
+  }
+
+  // Same-time events keep their script order, like the firmware queue
+  std::stable_sort(events.begin(), events.end(),
+                   [](const ScriptEvent& x, const ScriptEvent& y) { return x.timeMs < y.timeMs; });
+  if (endMs < 0.0) endMs = lastMs + 2000.0;
+  return true;
+}
+
+void put16(std::vector<uint8_t>& v, uint16_t x) {
+  v.push_back(x & 0xFF);
+  v.push_back(x >> 8);
+}
+
+void put32(std::vector<uint8_t>& v, uint32_t x) {
+  put16(v, x & 0xFFFF);
+  put16(v, x >> 16);
+}
+
+bool writeWav(const char* path, const std::vector<int16_t>& pcm, int sampleRate) {
+  std::vector<uint8_t> hdr;
+  const uint32_t bytes = (uint32_t)(pcm.size() * sizeof(int16_t));
+  hdr.insert(hdr.end(), {'R', 'I', 'F', 'F'});
+  put32(hdr, 36 + bytes);
+  hdr.insert(hdr.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+  put32(hdr, 16);
+  put16(hdr, 1);  // PCM
+  put16(hdr, 2);  // Stereo
+  put32(hdr, sampleRate);
+  put32(hdr, sampleRate * 4);
+  put16(hdr, 4);
+  put16(hdr, 16);
+  hdr.insert(hdr.end(), {'d', 'a', 't', 'a'});
+  put32(hdr, bytes);
+
+  FILE* f = fopen(path, "wb");
+  if (!f) {
+    fprintf(stderr, "Cannot write %s\n", path);
+    return false;
+  }
+  fwrite(hdr.data(), 1, hdr.size(), f);
+  for (int16_t s : pcm) {
+    uint8_t le[2] = {(uint8_t)(s & 0xFF), (uint8_t)((uint16_t)s >> 8)};
+    fwrite(le, 1, 2, f);
+  }
+  fclose(f);
+  return true;
+}
+
+// Reads the samples of a 16-bit PCM WAV (only what writeWav() produces needs to work)
+bool readWav(const char* path, std::vector<int16_t>& pcm) {
+  FILE* f = fopen(path, "rb");
+  if (!f) {
+    fprintf(stderr, "Cannot open reference %s\n", path);
+    return false;
+  }
+  uint8_t riff[12];
+  if (fread(riff, 1, 12, f) != 12 || memcmp(riff, "RIFF", 4) || memcmp(riff + 8, "WAVE", 4)) {
+    fprintf(stderr, "%s is not a WAV file\n", path);
+    fclose(f);
+    return false;
+  }
+  uint8_t chunk[8];
+  while (fread(chunk, 1, 8, f) == 8) {
+    uint32_t size = chunk[4] | (chunk[5] << 8) | (chunk[6] << 16) | ((uint32_t)chunk[7] << 24);
+    if (memcmp(chunk, "data", 4) == 0) {
+      std::vector<uint8_t> raw(size);
+      size = (uint32_t)fread(raw.data(), 1, size, f);
+      pcm.resize(size / 2);
+      for (size_t i = 0; i < pcm.size(); i++) {
+        pcm[i] = (int16_t)(raw[2 * i] | (raw[2 * i + 1] << 8));
+      }
+      fclose(f);
+      return true;
+    }
+    fseek(f, size + (size & 1), SEEK_CUR);
+  }
+  fprintf(stderr, "%s has no data chunk\n", path);
+  fclose(f);
+  return false;
+}
+
+// Prints max deviation and SNR against the reference; true if within tolerance
+bool compare(const std::vector<int16_t>& pcm, const std::vector<int16_t>& ref, int tolerance) {
+  if (pcm.size() != ref.size()) {
+    printf("compare: length differs (%zu vs %zu samples)\n", pcm.size(), ref.size());
+    return false;
+  }
+  int maxDiff = 0;
+  size_t firstDiff = pcm.size();
+  double signal = 0.0, noise = 0.0;
+  for (size_t i = 0; i < pcm.size(); i++) {
+    int d = std::abs(pcm[i] - ref[i]);
+    if (d > 0 && firstDiff == pcm.size()) firstDiff = i;
+    maxDiff = std::max(maxDiff, d);
+    signal += (double)ref[i] * ref[i];
+    noise += (double)d * d;
+  }
+
+  if (maxDiff == 0) {
+    printf("compare: bit-identical\n");
+    return true;
+  }
+  double snr = 10.0 * std::log10(signal / noise);
+  printf("compare: max diff %d LSB (first at frame %zu), SNR %.1f dB\n", maxDiff, firstDiff / 2, snr);
+  return maxDiff <= tolerance;
+}
+
+void usage() {
+  fprintf(stderr,
+          "usage: pico303-render <script> [-o out.wav] [--rate hz] [--block frames]\n"
+          "                      [--compare ref.wav] [--tolerance lsb]\n"
+          "                      [--kernels float|fixed] [--voices n]\n"
+          "                      [--osc polyblep|wavetable]\n"
+          "                      [--psram kb] [--delay-ms ms]\n"
+          "       pico303-render --kernel-bench [--rate hz]\n"
+          "       pico303-render --osc-test [--rate hz]\n"
+          "       pico303-render --tanh-test\n");
+}
+
+void printArena(const char* name, const EffectArena& arena) {
+  if (!arena.capacity()) return;
+  printf("%s arena: %zu of %zu bytes", name, arena.bytesUsed(), arena.capacity());
+  for (int i = 0; i < arena.allocationCount(); i++) {
+    printf(", %s %u", arena.allocation(i).owner, (unsigned)arena.allocation(i).bytes);
+  }
+  printf("\n");
+}
+
+void printKernelBench(int sampleRate) {
+  KernelBench bench;
+  if (!bench.run(nowNanos, sampleRate)) {
+    fprintf(stderr, "Failed to allocate benchmark buffers\n");
+    return;
+  }
+  printf("%-9s %10s %10s  (ns per %d-sample block)\n", "kernel", "float", "fixed", KernelBench::kBlock);
+  for (int k = 0; k < KernelBench::KERNEL_COUNT; k++) {
+    KernelBench::Kernel kernel = (KernelBench::Kernel)k;
+    printf("%-9s %10u %10u\n", KernelBench::kernelName(kernel),
+           (unsigned)bench.ticks(kernel, SynthEngine::KERNELS_FLOAT),
+           (unsigned)bench.ticks(kernel, SynthEngine::KERNELS_FIXED));
+  }
+  printf("%-9s %10u %10u  (oscillator, not in the total)\n", "wavetbl",
+         (unsigned)bench.wavetableTicks(SynthEngine::KERNELS_FLOAT),
+         (unsigned)bench.wavetableTicks(SynthEngine::KERNELS_FIXED));
+  printf("%-9s %10u %10u  fastest: %s\n", "total",
+         (unsigned)bench.total(SynthEngine::KERNELS_FLOAT),
+         (unsigned)bench.total(SynthEngine::KERNELS_FIXED),
+         KernelBench::setName(bench.fastest()));
+}
+
+// In-place radix-2 FFT (size a power of two)
+void fft(std::vector<std::complex<double>>& x) {
+  const size_t n = x.size();
+  for (size_t i = 1, j = 0; i < n; i++) {
+    size_t bit = n >> 1;
+    for (; j & bit; bit >>= 1) j ^= bit;
+    j |= bit;
+    if (i < j) std::swap(x[i], x[j]);
+  }
+  for (size_t len = 2; len <= n; len <<= 1) {
+    const std::complex<double> w = std::polar(1.0, -2.0 * M_PI / len);
+    for (size_t i = 0; i < n; i += len) {
+      std::complex<double> wk = 1.0;
+      for (size_t k = 0; k < len / 2; k++, wk *= w) {
+        std::complex<double> a = x[i + k], b = x[i + k + len / 2] * wk;
+        x[i + k] = a + b;
+        x[i + k + len / 2] = a - b;
+      }
+    }
+  }
+}
+
+struct Spectrum {
+  double aliasDb;     // Power off the harmonics, relative to the harmonics
+  double aliasLowDb;  // Same, below 15 kHz only
+  double harmonicDb;  // Harmonic power relative to the ideal band-limited waveform
+};
+
+// Splits a rendered tone into harmonic lines and everything else (aliases, noise).
+// cycles is the exact pitch in cycles per sample, idealPower the power of the
+// ideal band-limited waveform.
+Spectrum analyze(const std::vector<float>& y, double cycles, double idealPower, int sampleRate) {
+  const size_t n = y.size();
+  std::vector<std::complex<double>> x(n);
+  double windowPower = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    // 4-term Blackman-Harris: -92 dB sidelobes, main lobe +-4 bins
+    double t = 2.0 * M_PI * i / n;
+    double w = 0.35875 - 0.48829 * cos(t) + 0.14128 * cos(2 * t) - 0.01168 * cos(3 * t);
+    x[i] = y[i] * w;
+    windowPower += w * w;
+  }
+  fft(x);
+
+  const double binsPerHarmonic = cycles * n;
+  const double lowBin = 15000.0 / sampleRate * n;
+  double harmonic = 0.0, alias = 0.0, aliasLow = 0.0;
+  for (size_t k = 0; k <= n / 2; k++) {
+    double p = std::norm(x[k]);
+    double h = std::round(k / binsPerHarmonic);  // Nearest harmonic (0 = DC)
+    if (std::fabs(k - h * binsPerHarmonic) <= 6.0 && h * cycles < 0.5) {
+      if (h > 0) harmonic += p;
+    } else {
+      alias += p;
+      if (k < lowBin) aliasLow += p;
+    }
+  }
+  // One-sided sum of |X|^2 over a sine of amplitude A is A^2 / 4 * n * windowPower
+  const double measured = 2.0 * harmonic / (n * windowPower);
+  return { 10.0 * log10(alias / harmonic + 1e-30), 10.0 * log10(aliasLow / harmonic + 1e-30),
+           10.0 * log10(measured / idealPower) };
+}
+
+// Renders a single oscillator with both methods and kernel sets and prints the
+// aliasing against the harmonics, the harmonic level against an ideal additive
+// waveform, and the cost per sample
+void printOscTest(int sampleRate) {
+  constexpr int kSamples = 1 << 16;
+  constexpr int kRuns = 5;
+  const float freqs[] = { 55.0f, 220.0f, 880.0f, 1760.0f, 3520.0f };
+  const char* const methodNames[] = { "polyblep", "wavetable" };
+
+  printf("%-7s %6s %-10s %9s %9s %9s %9s %9s\n", "wave", "Hz", "method",
+         "alias dB", "<15k dB", "harm dB", "ns float", "ns fixed");
+  for (int wave = 0; wave < 2; wave++) {
+    const float blend = wave == 0 ? 1.0f : 0.0f;  // Saw, 53% pulse
+    for (float f : freqs) {
+      for (int m = 0; m < 2; m++) {
+        Oscillator osc;
+        osc.setSampleRate((float)sampleRate);
+        osc.setMode(true);
+        osc.setMethod((Oscillator::Method)m);
+        osc.setBlend(blend);
+        osc.setSubBlend(0.0f);
+
+        // Exact pitch of the 32-bit phase accumulator and the ideal harmonic power
+        const uint32_t inc = (uint32_t)(f / sampleRate * 4294967296.0f);
+        const double cycles = inc / 4294967296.0;
+        const double width = 0.53;
+        double idealPower = 0.0;
+        for (int h = 1; h * cycles < 0.5; h++) {
+          double amp = 0.707 * 2.0 / (M_PI * h);
+          if (wave == 1) amp *= 2.0 * std::fabs(sin(M_PI * h * width));
+          idealPower += amp * amp / 2.0;
+        }
+
+        // Float and fixed renders, best of kRuns for the timing
+        std::vector<float> y(kSamples);
+        std::vector<int32_t> q(kSamples);
+        double ns[2] = { 1e30, 1e30 };
+        for (int fixed = 0; fixed < 2; fixed++) {
+          for (int r = 0; r < kRuns; r++) {
+            osc.setFrequency(f);
+            uint32_t t0 = nowNanos();
+            for (int i = 0; i < kSamples; i += SynthEngine::kMaxFrames) {
+              if (fixed) osc.process(&q[i], SynthEngine::kMaxFrames);
+              else osc.process(&y[i], SynthEngine::kMaxFrames);
+            }
+            ns[fixed] = std::min(ns[fixed], (double)(uint32_t)(nowNanos() - t0) / kSamples);
+          }
+        }
+        Spectrum s = analyze(y, cycles, idealPower, sampleRate);
+        printf("%-7s %6.0f %-10s %9.1f %9.1f %9.2f %9.2f %9.2f\n", wave == 0 ? "saw" : "pulse", f,
+               methodNames[m], s.aliasDb, s.aliasLowDb, s.harmonicDb, ns[0], ns[1]);
+      }
+    }
+  }
+}
+
+// Max error of OutputStage::fastTanh(), OutputStage::tanhQ15() and the
+// fixed-point process() against std::tanh over the table range; false if one
+// is above the bound documented in OutputStage.h
+bool printTanhTest() {
+  constexpr double kRange = 8.0;  // tanhQ15() saturates here, fastTanh() clamps before it
+  constexpr int kPoints = 1 << 22;
+  constexpr double kFastBound = 1e-4;
+  constexpr double kInputGain = 0.10, kOutputScale = 30000.0;  // process() defaults
+  // Worst cases summed (OutputStage.h): rounded entries and rounded lerp (0.5 LSB
+  // each), the chord sag h^2/8 * max|tanh''| with h = 1/64 and
+  // max|tanh''| = 4 / (3 sqrt 3), and the fraction dropping 4 of x's 20 bits
+  // below the index (2^-22 at slope <= 1)
+  const double kTableBoundLsb = 0.5 + 0.5 + 32768.0 / (64.0 * 64.0 * 8.0) * 4.0 / (3.0 * std::sqrt(3.0))
+                                + 32768.0 / 4194304.0;
+  // The table bound at the output scale, the final rounding, and the truncated
+  // Q5.26 gain (1 unit, times the largest input) plus the truncated product
+  const double kOutputBoundLsb = kTableBoundLsb * kOutputScale / 32768.0 + 0.5
+                                 + (kRange / kInputGain + 1.0) / fixp::kSignalOne * kOutputScale;
+
+  double fastErr = 0.0, fastAt = 0.0, tableErr = 0.0, tableAt = 0.0;
+  for (int i = 0; i <= kPoints; i++) {
+    const double x = -kRange + 2.0 * kRange * i / kPoints;
+    const double e = std::fabs(OutputStage::fastTanh((float)x) - std::tanh(x));
+    if (e > fastErr) fastErr = e, fastAt = x;
+
+    const int32_t q = (int32_t)std::lrint(x * fixp::kSignalOne);
+    const double eq = std::fabs(OutputStage::tanhQ15(q) - std::tanh(q / (double)fixp::kSignalOne) * 32768.0);
+    if (eq > tableErr) tableErr = eq, tableAt = x;
+  }
+
+  // process() at the default gains, over the same clipper range
+  OutputStage output;
+  std::vector<int32_t> in(SynthEngine::kMaxFrames);
+  std::vector<int16_t> out(2 * SynthEngine::kMaxFrames);
+  double outErr = 0.0, outAt = 0.0;
+  for (int i = 0; i <= kPoints; i += SynthEngine::kMaxFrames) {
+    for (int k = 0; k < SynthEngine::kMaxFrames; k++) {
+      in[k] = (int32_t)std::lrint((-kRange + 2.0 * kRange * (i + k) / kPoints) / kInputGain * fixp::kSignalOne);
+    }
+    output.process(in.data(), in.data(), out.data(), SynthEngine::kMaxFrames);
+    for (int k = 0; k < SynthEngine::kMaxFrames; k++) {
+      const double x = in[k] / (double)fixp::kSignalOne * kInputGain;
+      const double e = std::fabs(out[2 * k] - std::tanh(x) * kOutputScale);
+      if (e > outErr) outErr = e, outAt = x;
+    }
+  }
+
+  const bool ok = fastErr < kFastBound && tableErr < kTableBoundLsb && outErr < kOutputBoundLsb;
+  printf("%-10s %12s %10s %10s\n", "tanh", "max error", "bound", "at x");
+  printf("%-10s %12.3g %10.3g %10.4f\n", "fastTanh", fastErr, kFastBound, fastAt);
+  printf("%-10s %8.3f LSB %6.2f LSB %10.4f\n", "tanhQ15", tableErr, kTableBoundLsb, tableAt);
+  printf("%-10s %8.3f LSB %6.2f LSB %10.4f\n", "fixed out", outErr, kOutputBoundLsb, outAt);
+  printf("tanh-test: %s\n", ok ? "ok" : "FAILED");
+  return ok;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const char* scriptPath = nullptr;
+  const char* outPath = "out.wav";
+  const char* refPath = nullptr;
+  int sampleRate = 44100;
+  int blockSize = 256;
+  int tolerance = 0;
+  int kernels = -1;  // Engine default
+  int voiceCount = 1;
+  int oscMethod = -1;  // Oscillator default
+  int psramKb = 0;
+  int delayMs = 0;  // AudioConfig default
+  bool kernelBench = false;
+  bool oscTest = false;
+  bool tanhTest = false;
+
+  for (int i = 1; i < argc; i++) {
+    bool hasValue = i + 1 < argc;
+    if (!strcmp(argv[i], "-o") && hasValue) outPath = argv[++i];
+    else if (!strcmp(argv[i], "--rate") && hasValue) sampleRate = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--block") && hasValue) blockSize = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--compare") && hasValue) refPath = argv[++i];
+    else if (!strcmp(argv[i], "--tolerance") && hasValue) tolerance = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--kernels") && hasValue && !strcmp(argv[i + 1], "float")) kernels = SynthEngine::KERNELS_FLOAT, i++;
+    else if (!strcmp(argv[i], "--kernels") && hasValue && !strcmp(argv[i + 1], "fixed")) kernels = SynthEngine::KERNELS_FIXED, i++;
+    else if (!strcmp(argv[i], "--voices") && hasValue) voiceCount = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--osc") && hasValue && !strcmp(argv[i + 1], "polyblep")) oscMethod = Oscillator::POLYBLEP, i++;
+    else if (!strcmp(argv[i], "--osc") && hasValue && !strcmp(argv[i + 1], "wavetable")) oscMethod = Oscillator::WAVETABLE, i++;
+    else if (!strcmp(argv[i], "--psram") && hasValue) psramKb = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--delay-ms") && hasValue) delayMs = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--kernel-bench")) kernelBench = true;
+    else if (!strcmp(argv[i], "--osc-test")) oscTest = true;
+    else if (!strcmp(argv[i], "--tanh-test")) tanhTest = true;
+    else if (argv[i][0] != '-' && !scriptPath) scriptPath = argv[i];
+    else {
+      usage();
+      return 2;
+    }
+  }
+  if ((!scriptPath && !kernelBench && !oscTest && !tanhTest) || sampleRate <= 0 || blockSize <= 0) {
+    usage();
+    return 2;
+  }
+
+#if defined(__SSE__)
+  // Flush denormals like the board's FPU does cheaply; x86 stalls on them
+  // and would make decaying tails dominate the timings.
+  _mm_setcsr(_mm_getcsr() | 0x8040);  // FTZ | DAZ
+#endif
+
+  if (kernelBench) printKernelBench(sampleRate);
+  if (oscTest) printOscTest(sampleRate);
+  if (tanhTest && !printTanhTest()) return 1;
+  if (!scriptPath) return 0;
+
+  std::vector<ScriptEvent> events;
+  double endMs;
+  if (!loadScript(scriptPath, events, endMs)) return 1;
+
+  AudioConfig config;
+  config.sampleRate = sampleRate;
+  config.blockFrames = blockSize;
+  if (delayMs > 0) config.maxDelayMs = delayMs;
+  else if (sampleRate > 48000 && psramKb <= 0) config.maxDelayMs = 500;  // Fits EFFECT_ARENA_KB
+  std::vector<uint8_t> psram((size_t)std::max(psramKb, 0) * 1024);
+  if (psramKb > 0) EffectArena::psram().begin(psram.data(), psram.size(), true);
+
+  static SynthEngine engine;  // Too big for the stack (scratch buffers)
+  if (!engine.begin(config)) {
+    fprintf(stderr, "Failed to allocate delay buffer\n");
+    return 1;
+  }
+  engine.setProfileClock(nowNanos);
+  if (kernels >= 0) engine.setKernelSet((SynthEngine::KernelSet)kernels);
+  engine.setVoiceCount(voiceCount);
+  if (oscMethod >= 0) engine.setOscMethod((Oscillator::Method)oscMethod);
+
+  const long totalFrames = (long)(endMs * 1e-3 * sampleRate);
+  std::vector<int16_t> pcm((size_t)totalFrames * 2);
+
+  // Walk the blocks like fillAudioBlock(), but with exact event positions
+  size_t next = 0;
+  double stageNs[SynthEngine::STAGE_COUNT] = {};
+  const auto t0 = std::chrono::steady_clock::now();
+  for (long blockStart = 0; blockStart < totalFrames; blockStart += blockSize) {
+    const long blockEnd = std::min(blockStart + blockSize, totalFrames);
+    long pos = blockStart;
+    while (next < events.size()) {
+      const ScriptEvent& ev = events[next];
+      long at = std::max(pos, (long)(ev.timeMs * 1e-3 * sampleRate));
+      if (at >= blockEnd) break;
+
+      engine.render(&pcm[pos * 2], (int)(at - pos));
+      pos = at;
+      switch (ev.type) {
+        case ScriptEvent::ON:    engine.noteOn(ev.channel, ev.data1, ev.data2); break;
+        case ScriptEvent::OFF:   engine.noteOff(ev.channel, ev.data1, 0); break;
+        case ScriptEvent::CC:    engine.controlChange(ev.channel, ev.data1, ev.data2); break;
+        case ScriptEvent::NRPN:  engine.nrpn(ev.channel, ev.data1, (ev.data2 << 7) | ev.data3); break;
+        case ScriptEvent::CLOCK: engine.clock((uint32_t)(ev.timeMs * 1000.0)); break;
+        case ScriptEvent::START:    engine.start(); break;
+        case ScriptEvent::CONTINUE: engine.resume(); break;
+        case ScriptEvent::STOP:     engine.stop(); break;
+        case ScriptEvent::SPP:      engine.songPosition(ev.data1 | (ev.data2 << 7)); break;
+        case ScriptEvent::PATTERN:  engine.setPattern(scriptPatterns[ev.data1]); break;
+        case ScriptEvent::SEQ:
+          switch (ev.data1) {
+            case SEQ_START:    engine.startSequencer(); break;
+            case SEQ_STOP:     engine.stopSequencer(); break;
+            case SEQ_INTERNAL: engine.setSequencerSync(StepSequencer::INTERNAL); break;
+            case SEQ_CLOCK:    engine.setSequencerSync(StepSequencer::MIDI_CLOCK); break;
+            case SEQ_TEMPO:    engine.setSequencerTempo(ev.value); break;
+          }
+          break;
+      }
+      next++;
+    }
+    engine.render(&pcm[pos * 2], (int)(blockEnd - pos));
+
+    // The engine's 32-bit counters would wrap on long renders
+    const uint32_t* ticks = engine.getStageTicks();
+    for (int s = 0; s < SynthEngine::STAGE_COUNT; s++) stageNs[s] += ticks[s];
+    engine.resetStageTicks();
+  }
+  const double wallNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+
+  if (!writeWav(outPath, pcm, sampleRate)) return 1;
+  printf("%s: %ld frames (%.2f s) at %d Hz, %zu events, %s kernels, %d voice(s)\n",
+         outPath, totalFrames, totalFrames / (double)sampleRate, sampleRate, events.size(),
+         KernelBench::setName(engine.getKernelSet()), engine.getVoiceCount());
+  printArena("sram", EffectArena::sram());
+  printArena("psram", EffectArena::psram());
+
+  // Per-stage cost. The profile clock itself adds a little to every stage.
+  double stageTotal = 0.0;
+  printf("%-8s %10s\n", "stage", "ns/sample");
+  for (int s = 0; s < SynthEngine::STAGE_COUNT; s++) {
+    double ns = stageNs[s] / totalFrames;
+    stageTotal += ns;
+    printf("%-8s %10.2f\n", kStageNames[s], ns);
+  }
+  printf("%-8s %10.2f  (wall %.2f, realtime x%.0f)\n", "total", stageTotal,
+         wallNs / totalFrames, 1e9 / sampleRate / (wallNs / totalFrames));
+
+  if (refPath) {
+    std::vector<int16_t> ref;
+    if (!readWav(refPath, ref)) return 1;
+    if (!compare(pcm, ref, tolerance)) return 3;
+  }
+  return 0;
+}
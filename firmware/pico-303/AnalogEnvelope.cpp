@@ -4,6 +4,7 @@
  */
 
 #include "AnalogEnvelope.h"
+#include "HotPath.h"
 
 void AnalogEnvelope::setSampleRate(float sr) {
   sampleRate = sr;
@@ -39,7 +40,7 @@ void AnalogEnvelope::noteOff() {
   state = RELEASE;
 }
 
-float AnalogEnvelope::process() {
+float SYNTH_RAM_FUNC(AnalogEnvelope::process)() {
   if (state == ATTACK) {
     currentLevel += attackCoeff;
     if (currentLevel >= 1.0f) {
@@ -63,13 +64,53 @@ float AnalogEnvelope::process() {
   return currentLevel;
 }
 
+void SYNTH_RAM_FUNC(AnalogEnvelope::process)(float* out, int n) {
+  float level = currentLevel;
+  int i = 0;
+  while (i < n) {
+    if (state == ATTACK) {
+      for (; i < n; i++) {
+        level += attackCoeff;
+        if (level >= 1.0f) {
+          out[i++] = level = 1.0f;
+          state = DECAY;
+          break;
+        }
+        out[i] = level;
+      }
+    } else if (state == DECAY || state == RELEASE) {
+      const float c = (state == DECAY) ? decayCoeff : releaseCoeff;
+      for (; i < n; i++) {
+        level *= c;
+        if (level < 0.0001f) {
+          out[i++] = level = 0.0f;
+          state = IDLE;
+          break;
+        }
+        out[i] = level;
+      }
+    } else {
+      for (; i < n; i++) out[i] = level;
+    }
+  }
+  currentLevel = level;
+}
+
 bool AnalogEnvelope::isActive() const {
   return isNoteOn;
 }
 
+bool SYNTH_RAM_FUNC(AnalogEnvelope::isIdle)() const {
+  return state == IDLE;
+}
+
+float AnalogEnvelope::coeffFor(float ms, float sr) {
+  return std::exp(-1.0f / (0.001f * ms * sr));
+}
+
 void AnalogEnvelope::calculateCoeffs() {
-  decayCoeff = std::exp(-1.0f / (0.001f * decayTime * sampleRate));
-  releaseCoeff = std::exp(-1.0f / (0.001f * releaseTime * sampleRate));
+  decayCoeff = coeffFor(decayTime, sampleRate);
+  releaseCoeff = coeffFor(releaseTime, sampleRate);
   // Linear attack: increment per sample = 1.0 / (samples)
   float attackSamples = 0.001f * attackTime * sampleRate;
   if (attackSamples < 1.0f) attackSamples = 1.0f;
@@ -32,6 +32,20 @@ public:
    */
   void setRelease(float ms);
 
+  /**
+   * @brief Sets the release factor directly, e.g. one cached with coeffFor()
+   * (setRelease() recomputes all three coefficients).
+   * @param c Factor from coeffFor()
+   */
+  void setReleaseCoeff(float c) { releaseCoeff = c; }
+
+  /**
+   * @brief Per-sample factor of an exponential segment (decay, release).
+   * @param ms Time constant in milliseconds
+   * @param sr Sample rate in Hz
+   */
+  static float coeffFor(float ms, float sr);
+
   /**
    * @brief Sets the attack time.
    * @param ms Attack time in milliseconds
@@ -53,6 +67,13 @@ public:
    * @return float Envelope level [0.0 ... 1.0]
    */
   float process();
+
+  /**
+   * @brief Processes a block of envelope samples.
+   * @param out Output buffer (n values)
+   * @param n Number of samples
+   */
+  void process(float* out, int n);
   
   /**
    * @brief Checks if the envelope is currently active (Note On).
@@ -60,6 +81,12 @@ public:
    */
   bool isActive() const;
 
+  /**
+   * @brief Checks if the envelope has finished (level 0 until the next Note On).
+   * @return true in the idle state
+   */
+  bool isIdle() const;
+
 private:
   enum State { IDLE, ATTACK, DECAY, RELEASE };
   State state = IDLE;
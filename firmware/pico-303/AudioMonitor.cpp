@@ -0,0 +1,104 @@
+/**
+ * @file AudioMonitor.cpp
+ * @brief Implementation of the AudioMonitor class and the profile clock.
+ */
+
+#include "AudioMonitor.h"
+#include "HotPath.h"
+#include <Arduino.h>
+
+#if defined(__ARM_ARCH_8M_MAIN__)
+// Cortex-M33 debug registers (ARMv8-M architecture, same address on both cores)
+#define DEMCR      (*(volatile uint32_t*)0xE000EDFCu)
+#define DWT_CTRL   (*(volatile uint32_t*)0xE0001000u)
+#define DWT_CYCCNT (*(volatile uint32_t*)0xE0001004u)
+#define DEMCR_TRCENA       (1u << 24)
+#define DWT_CTRL_CYCCNTENA (1u << 0)
+
+uint32_t SYNTH_RAM_FUNC(profileTicks)() {
+  return DWT_CYCCNT;
+}
+
+uint32_t profileClockBegin() {
+  DEMCR |= DEMCR_TRCENA;
+  DWT_CYCCNT = 0;
+  DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+  return rp2040.f_cpu();
+}
+#elif defined(__riscv)
+// Hazard3 machine-mode cycle counter
+#define CSR_MCOUNTINHIBIT 0x320
+
+uint32_t SYNTH_RAM_FUNC(profileTicks)() {
+  uint32_t cycles;
+  __asm__ volatile("csrr %0, mcycle" : "=r"(cycles));
+  return cycles;
+}
+
+uint32_t profileClockBegin() {
+  // The counter is inhibited out of reset
+  __asm__ volatile("csrci %0, 1" : : "i"(CSR_MCOUNTINHIBIT));
+  return rp2040.f_cpu();
+}
+#else
+uint32_t profileTicks() {
+  return time_us_32();
+}
+
+uint32_t profileClockBegin() {
+  return 1000000u;
+}
+#endif
+
+void AudioMonitor::begin(uint32_t budgetTicks, uint32_t bufferBytes) {
+  published.budgetTicks = budgetTicks;
+  published.bufferBytes = bufferBytes;
+}
+
+void SYNTH_RAM_FUNC(AudioMonitor::blockDone)(uint32_t ticks, const uint32_t* stageTicks) {
+  totalBlocks++;
+  windowBlocks++;
+  windowTicks += ticks;
+  if (ticks > peakBlock) peakBlock = ticks;
+  if (ticks < minBlock) minBlock = ticks;
+  for (int s = 0; s < SynthEngine::STAGE_COUNT; s++) windowStageTicks[s] += stageTicks[s];
+
+  if (windowBlocks < kWindowBlocks) return;
+
+  // Publish the window
+  uint32_t seq = sequence.load(std::memory_order_relaxed);
+  sequence.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  published.blocks = totalBlocks;
+  published.avgBlockTicks = (uint32_t)(windowTicks / windowBlocks);
+  published.peakBlockTicks = peakBlock;
+  published.minBlockTicks = minBlock;
+  published.peakFreeBytes = peakFree;
+  for (int s = 0; s < SynthEngine::STAGE_COUNT; s++) {
+    published.stageTicks[s] = windowStageTicks[s] / windowBlocks;
+    windowStageTicks[s] = 0;
+  }
+
+  std::atomic_thread_fence(std::memory_order_release);
+  sequence.store(seq + 2, std::memory_order_relaxed);
+
+  windowBlocks = 0;
+  windowTicks = 0;
+  if (resetRequested.exchange(false, std::memory_order_relaxed)) {
+    peakBlock = 0;
+    minBlock = UINT32_MAX;
+    peakFree = 0;
+  }
+}
+
+void AudioMonitor::read(Snapshot& out) const {
+  uint32_t before, after;
+  do {
+    before = sequence.load(std::memory_order_acquire);
+    out = published;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = sequence.load(std::memory_order_relaxed);
+  } while ((before & 1) || before != after);
+  out.underruns = underruns.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+
+#include "SynthEngine.h"
+
+/**
+ * @file AudioMonitor.h
+ * @brief Audio core load and I2S underrun statistics.
+ */
+
+/**
+ * @brief Free-running profile clock for the calling core.
+ * DWT cycle counter on the Cortex-M33 cores, mcycle on Hazard3 (RISC-V),
+ * time_us_32() otherwise.
+ */
+uint32_t profileTicks();
+
+/**
+ * @brief Enables the profile clock on the calling core (the DWT is per core).
+ * @return Profile clock rate in ticks per second
+ */
+uint32_t profileClockBegin();
+
+/**
+ * @class AudioMonitor
+ * @brief Collects per-block render cost, per-stage cost, I2S underruns and the
+ * buffer high-water mark on the audio core, and publishes them for the control
+ * core (SysEx replies, OLED) without any printf in the audio path.
+ *
+ * The audio core writes, the control core reads; snapshots are published once
+ * per window through a sequence counter so the reader never sees a torn copy.
+ */
+class AudioMonitor {
+public:
+  /// Blocks averaged per published snapshot
+  static constexpr uint32_t kWindowBlocks = 64;
+
+  struct Snapshot {
+    uint32_t blocks = 0;          ///< Blocks rendered since boot
+    uint32_t underruns = 0;       ///< I2S DMA underflows since boot
+    uint32_t budgetTicks = 0;     ///< Ticks per block at 100% load
+    uint32_t avgBlockTicks = 0;   ///< Mean fillAudioBlock() cost over the last window
+    uint32_t peakBlockTicks = 0;  ///< Worst fillAudioBlock() cost since the last reset
+    uint32_t minBlockTicks = 0;   ///< Best fillAudioBlock() cost since the last reset (peak - min = jitter)
+    uint32_t peakFreeBytes = 0;   ///< High-water mark of availableForWrite() (closest to underrun)
+    uint32_t bufferBytes = 0;     ///< Total I2S buffer size
+    uint32_t stageTicks[SynthEngine::STAGE_COUNT] = {}; ///< Mean per-block cost of each stage
+  };
+
+  /**
+   * @brief Sets the scale for load figures (audio core).
+   * @param budgetTicks Profile ticks per block at 100% load
+   * @param bufferBytes Total I2S buffer size in bytes
+   */
+  void begin(uint32_t budgetTicks, uint32_t bufferBytes);
+
+  /**
+   * @brief Records one rendered block (audio core).
+   * @param ticks Cost of the whole block
+   * @param stageTicks Per-stage cost of the block (SynthEngine::getStageTicks())
+   */
+  void blockDone(uint32_t ticks, const uint32_t* stageTicks);
+
+  /**
+   * @brief Records the free I2S space seen before writing a block (audio core).
+   * @param bytes availableForWrite() result
+   */
+  void noteFree(uint32_t bytes) {
+    if (bytes > peakFree) peakFree = bytes;
+  }
+
+  /**
+   * @brief Counts an I2S underflow (audio core, DMA interrupt).
+   */
+  void underrun() { underruns.fetch_add(1, std::memory_order_relaxed); }
+
+  /**
+   * @brief Copies the latest published snapshot (control core).
+   * @param out Receives the snapshot
+   */
+  void read(Snapshot& out) const;
+
+  /**
+   * @brief Asks the audio core to clear the peak figures at the next window (control core).
+   */
+  void requestReset() { resetRequested.store(true, std::memory_order_relaxed); }
+
+  /**
+   * @brief Converts ticks per block to load in 1/1000 of the block budget.
+   */
+  static uint32_t toPermille(uint32_t ticks, uint32_t budgetTicks) {
+    return budgetTicks ? (uint32_t)((uint64_t)ticks * 1000u / budgetTicks) : 0;
+  }
+
+private:
+  // Audio core accumulators
+  uint32_t windowBlocks = 0;
+  uint64_t windowTicks = 0;
+  uint32_t windowStageTicks[SynthEngine::STAGE_COUNT] = {};
+  uint32_t peakBlock = 0;
+  uint32_t minBlock = UINT32_MAX;
+  uint32_t peakFree = 0;
+  uint32_t totalBlocks = 0;
+
+  std::atomic<uint32_t> underruns{0};
+  std::atomic<bool> resetRequested{false};
+
+  // Published copy (odd sequence = being written)
+  Snapshot published;
+  std::atomic<uint32_t> sequence{0};
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file CcCoalescer.h
+ * @brief Latest-value-per-CC buffer with a bounded flush rate.
+ */
+
+/**
+ * @class CcCoalescer
+ * @brief Keeps the newest value of each CC until flush() passes them on, at
+ * most once per interval. A burst of changes to one CC (an accelerated
+ * encoder sweep) goes out as its final value; a change after a quiet
+ * interval goes out on the next flush() without waiting.
+ *
+ * Pending CCs are flushed in CC number order, not in the order they were set.
+ * Single-threaded (core 0).
+ */
+class CcCoalescer {
+public:
+  /// @param intervalMicros Minimum time between two flushes that send anything
+  explicit CcCoalescer(uint32_t intervalMicros) : interval(intervalMicros) {}
+
+  /// Records a value; replaces a pending one for the same CC
+  void set(uint8_t cc, uint8_t value) {
+    cc &= 0x7F;
+    values[cc] = value;
+    pending[cc >> 5] |= 1u << (cc & 31);
+  }
+
+  bool hasPending() const { return (pending[0] | pending[1] | pending[2] | pending[3]) != 0; }
+
+  /**
+   * @brief Passes every pending CC to send(cc, value) if the interval has passed.
+   * @param nowMicros Current time (micros())
+   * @param send Callable taking (uint8_t cc, uint8_t value)
+   * @return Number of CCs sent
+   */
+  template <typename F>
+  int flush(uint32_t nowMicros, F&& send) {
+    if (!hasPending() || nowMicros - lastFlush < interval) return 0;
+    lastFlush = nowMicros;
+    int sent = 0;
+    for (int w = 0; w < 4; w++) {
+      uint32_t bits = pending[w];
+      pending[w] = 0;
+      while (bits) {
+        const int cc = w * 32 + __builtin_ctz(bits);
+        bits &= bits - 1;
+        send((uint8_t)cc, values[cc]);
+        sent++;
+      }
+    }
+    return sent;
+  }
+
+private:
+  uint8_t values[128] = {};
+  uint32_t pending[4] = {};
+  uint32_t interval;
+  uint32_t lastFlush = 0;
+};
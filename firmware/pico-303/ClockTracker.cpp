@@ -0,0 +1,56 @@
+/**
+ * @file ClockTracker.cpp
+ * @brief Implementation of the ClockTracker class.
+ */
+
+#include "ClockTracker.h"
+#include <cmath>
+
+bool ClockTracker::tick(uint32_t now) {
+  if (count > 0) {
+    const uint32_t last = at(count - 1);
+    if (now - last > kTimeoutMicros) {
+      restart();
+    } else if (hasTempo() && count > kJumpTicks) {
+      const float expected = kJumpTicks * periodMicros;
+      const float span = (float)(now - at(count - kJumpTicks));
+      if (std::fabs(span - expected) > kJumpTolerance * expected) {
+        restart();
+        push(last);
+      }
+    }
+  }
+  push(now);
+
+  if (count < 3) return false;
+  fit();
+  return true;
+}
+
+void ClockTracker::restart() {
+  count = 0;
+  head = 0;
+}
+
+void ClockTracker::push(uint32_t now) {
+  times[head] = now;
+  head = (head + 1) % kWindow;
+  if (count < kWindow) count++;
+}
+
+/**
+ * @brief Least-squares slope of arrival time over tick index.
+ * Times are taken relative to the oldest tick, so the float sums stay exact
+ * enough for the two-beat window.
+ */
+void ClockTracker::fit() {
+  const int n = count;
+  const uint32_t t0 = at(0);
+  const float meanX = 0.5f * (n - 1);
+  float sxy = 0.0f;
+  for (int i = 0; i < n; i++) {
+    sxy += (i - meanX) * (float)(at(i) - t0);
+  }
+  const float sxx = n * ((float)n * n - 1.0f) / 12.0f;
+  periodMicros = sxy / sxx;
+}
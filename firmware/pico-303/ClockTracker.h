@@ -0,0 +1,60 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file ClockTracker.h
+ * @brief Jitter-filtered tempo estimate from MIDI clock ticks.
+ */
+
+/**
+ * @class ClockTracker
+ * @brief Estimates the tick period with a least-squares line fit over the
+ * arrival times of the last kWindow ticks (24 ppqn).
+ * USB delivers ticks with a millisecond or so of jitter; fitting a line through
+ * two beats of ticks instead of timing the last beat cuts that to a few
+ * microseconds per tick. When the last kJumpTicks intervals together miss the
+ * fitted period by more than kJumpTolerance, the window restarts, so tempo
+ * changes are followed within a few ticks. A gap longer than kTimeoutMicros
+ * (clock stopped) also starts over.
+ */
+class ClockTracker {
+public:
+  /// Ticks in the fit (two beats)
+  static constexpr int kWindow = 48;
+  /// Relative error of the last kJumpTicks intervals that counts as a tempo change
+  static constexpr float kJumpTolerance = 0.1f;
+  /// Intervals checked for a tempo change (timestamp jitter does not add up over them)
+  static constexpr int kJumpTicks = 3;
+  /// Longest tick interval that still belongs to a running clock (10 BPM)
+  static constexpr uint32_t kTimeoutMicros = 250000;
+
+  /**
+   * @brief Adds a tick.
+   * @param now Arrival time in microseconds
+   * @return true if the tempo estimate was updated
+   */
+  bool tick(uint32_t now);
+
+  /**
+   * @brief Forgets the tick history (e.g. on Start, the clock source may have changed).
+   * The last estimate stays valid until new ticks replace it.
+   */
+  void restart();
+
+  /// True once at least two intervals have been fitted
+  bool hasTempo() const { return periodMicros > 0.0f; }
+
+  /// Fitted tempo in BPM (valid if hasTempo())
+  float getBpm() const { return 60.0e6f / (periodMicros * 24.0f); }
+
+private:
+  uint32_t times[kWindow];
+  int count = 0;   // Ticks in the window
+  int head = 0;    // Next slot to write (the oldest tick once the window is full)
+  float periodMicros = 0.0f;
+
+  /// i-th tick of the window, 0 = oldest
+  uint32_t at(int i) const { return times[(head - count + i + kWindow) % kWindow]; }
+  void push(uint32_t now);
+  void fit();
+};
@@ -0,0 +1,110 @@
+#pragma once
+#include <array>
+#include <stdint.h>
+
+/**
+ * @file ControlCurves.h
+ * @brief Compile-time 0-127 -> parameter value tables for the CC handlers.
+ *
+ * libm is not usable in constant expressions, so the few curves that need
+ * exp/log are built with the small series helpers below. The tables end up
+ * in .rodata; no pow()/log2f() runs when a CC arrives. log2Fast()/exp2Fast()
+ * cover the few run-time cases (glide steps) without libm.
+ */
+
+namespace curves {
+
+/// exp(x) by argument halving and a Taylor series (double precision, constexpr)
+constexpr double cexp(double x) {
+  int halvings = 0;
+  while (x > 0.5 || x < -0.5) {
+    x *= 0.5;
+    halvings++;
+  }
+  double term = 1.0, sum = 1.0;
+  for (int n = 1; n < 20; n++) {
+    term *= x / n;
+    sum += term;
+  }
+  while (halvings-- > 0) sum *= sum;
+  return sum;
+}
+
+/// ln(x) for x > 0: scale into [0.5, 1), then the atanh series
+constexpr double clog(double x) {
+  constexpr double kLn2 = 0.69314718055994530942;
+  int e = 0;
+  while (x >= 1.0) { x *= 0.5; e++; }
+  while (x < 0.5) { x *= 2.0; e--; }
+  double z = (x - 1.0) / (x + 1.0);
+  double z2 = z * z, term = z, sum = 0.0;
+  for (int n = 1; n < 60; n += 2) {
+    sum += term / n;
+    term *= z2;
+  }
+  return 2.0 * sum + e * kLn2;
+}
+
+/// base^exponent for base >= 0
+constexpr double cpow(double base, double exponent) {
+  return base <= 0.0 ? 0.0 : cexp(exponent * clog(base));
+}
+
+template <typename F>
+constexpr std::array<float, 128> makeTable(F f) {
+  std::array<float, 128> t{};
+  for (int v = 0; v < 128; v++) t[v] = (float)f(v);
+  return t;
+}
+
+/// MIDI note -> frequency in Hz (A4 = note 69 = 440 Hz)
+inline constexpr std::array<float, 128> kNoteHz =
+  makeTable([](int n) { return 440.0 * cexp((n - 69) / 12.0 * 0.69314718055994530942); });
+
+/// CC16: pitch offset ratio, +-12 semitones ((v - 64) * 12/64 semitones)
+inline constexpr std::array<float, 128> kPitchRatio =
+  makeTable([](int v) { return cexp((v - 64) / 64.0 * 0.69314718055994530942); });
+
+/// CC74: exponential cutoff, 300 Hz .. 3000 Hz
+inline constexpr std::array<float, 128> kCutoffHz =
+  makeTable([](int v) { return 300.0 * cpow(3000.0 / 300.0, v / 127.0); });
+
+/// CC71: resonance shaping (v/127)^0.8
+inline constexpr std::array<float, 128> kResonance =
+  makeTable([](int v) { return cpow(v / 127.0, 0.8); });
+
+/**
+ * @brief Delay sync division for CC86/91/92: 0-127 -> 1/16, 1/8, 1/4 ... beats.
+ * Division index d = max(1, v / 16), beats = 2^(d - 1) / 4.
+ */
+constexpr int delayDivision(uint8_t v) { return v / 16 < 1 ? 1 : v / 16; }
+constexpr float divisionBeats(int div) { return (float)(1u << (div - 1)) * 0.25f; }
+
+/// Beat multiplier for the delay rhythm modifiers (CC93/94): straight, dotted, triplet
+inline constexpr float kDelayModifier[3] = { 1.0f, 1.5f, 2.0f / 3.0f };
+
+/// log2(x) for x > 0 (normal floats), about 1e-7 relative error
+inline float log2Fast(float x) {
+  union { float f; uint32_t u; } v = { x };
+  int e = (int)((v.u >> 23) & 0xFF) - 127;
+  v.u = (v.u & 0x007FFFFF) | 0x3F800000;  // Mantissa in [1, 2)
+  float m = v.f;
+  if (m > 1.41421356f) { m *= 0.5f; e++; }  // Center on 1: m in [0.71, 1.41]
+  // atanh series: ln(m) = 2 (z + z^3/3 + z^5/5 + z^7/7), |z| < 0.172
+  const float z = (m - 1.0f) / (m + 1.0f), z2 = z * z;
+  const float ln = 2.0f * z * (1.0f + z2 * (1.0f / 3 + z2 * (1.0f / 5 + z2 * (1.0f / 7))));
+  return (float)e + ln * 1.44269504f;
+}
+
+/// 2^x for |x| < 126, about 1e-7 relative error
+inline float exp2Fast(float x) {
+  const float i = (float)(int)(x + (x < 0.0f ? -0.5f : 0.5f));  // Nearest integer
+  const float f = (x - i) * 0.69314718f;                       // |f| <= ln(2) / 2
+  // Taylor series of e^f to the 7th power
+  float p = 1.0f + f * (1.0f + f * (1.0f / 2 + f * (1.0f / 6 + f * (1.0f / 24 + f * (1.0f / 120 +
+            f * (1.0f / 720 + f * (1.0f / 5040)))))));
+  union { uint32_t u; float f; } scale = { (uint32_t)((int)i + 127) << 23 };
+  return p * scale.f;
+}
+
+}  // namespace curves
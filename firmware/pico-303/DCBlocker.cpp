@@ -4,6 +4,8 @@
  */
 
 #include "DCBlocker.h"
+#include "HotPath.h"
+#include "FixedPoint.h"
 
 void DCBlocker::setSampleRate(float sr) {
   sampleRate = sr;
@@ -15,7 +17,7 @@ void DCBlocker::setCutoff(float hz) {
   calculateCoeff();
 }
 
-float DCBlocker::process(float input) {
+float SYNTH_RAM_FUNC(DCBlocker::process)(float input) {
   // y[n] = x[n] - x[n-1] + R * y[n-1]
   // Simple DC blocker algorithm
   float output = input - lastInput + R * lastOutput;
@@ -24,13 +26,49 @@ float DCBlocker::process(float input) {
   return output;
 }
 
+void SYNTH_RAM_FUNC(DCBlocker::process)(float* buf, int n) {
+  float x1 = lastInput;
+  float y1 = lastOutput;
+  const float r = R;
+  for (int i = 0; i < n; i++) {
+    float x = buf[i];
+    y1 = x - x1 + r * y1;
+    x1 = x;
+    buf[i] = y1;
+  }
+  lastInput = x1;
+  lastOutput = y1;
+}
+
 // Alternative 1-pole HPF: y = x - lpf(x)
 // This is often more stable for simple HPF use
-float DCBlocker::processHPF(float input) {
+float SYNTH_RAM_FUNC(DCBlocker::processHPF)(float input) {
   lpfState += (input - lpfState) * alpha;
   return input - lpfState;
 }
 
+void SYNTH_RAM_FUNC(DCBlocker::processHPF)(float* buf, int n) {
+  float state = lpfState;
+  const float a = alpha;
+  for (int i = 0; i < n; i++) {
+    float x = buf[i];
+    state += (x - state) * a;
+    buf[i] = x - state;
+  }
+  lpfState = state;
+}
+
+void SYNTH_RAM_FUNC(DCBlocker::processHPF)(int32_t* buf, int n) {
+  int32_t state = fixp::toSignal(lpfState);
+  const int32_t a = fixp::toQ(alpha, 31);
+  for (int i = 0; i < n; i++) {
+    int32_t x = buf[i];
+    state += fixp::mul<31>(x - state, a);
+    buf[i] = x - state;
+  }
+  lpfState = fixp::fromSignal(state);
+}
+
 void DCBlocker::calculateCoeff() {
   // For standard DC blocker: R = 1 - (2*pi*fc/fs)
   R = 1.0f - (2.0f * M_PI * cutoff / sampleRate);
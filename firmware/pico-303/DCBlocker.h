@@ -1,5 +1,6 @@
 #pragma once
 #include <cmath>
+#include <stdint.h>
 
 /**
  * @file DCBlocker.h
@@ -31,6 +32,13 @@ public:
    * @return float Output sample
    */
   float process(float input);
+
+  /**
+   * @brief Processes a block in place using the standard DC blocker algorithm.
+   * @param buf Input/output buffer (n values)
+   * @param n Number of samples
+   */
+  void process(float* buf, int n);
   
   /**
    * @brief Processes a sample using a 1-pole Highpass Filter (HPF).
@@ -40,6 +48,20 @@ public:
    */
   float processHPF(float input);
 
+  /**
+   * @brief Processes a block in place using the 1-pole HPF.
+   * @param buf Input/output buffer (n values)
+   * @param n Number of samples
+   */
+  void processHPF(float* buf, int n);
+
+  /**
+   * @brief Processes a Q5.26 block in place using the 1-pole HPF (see FixedPoint.h).
+   * @param buf Input/output buffer (n values)
+   * @param n Number of samples
+   */
+  void processHPF(int32_t* buf, int n);
+
 private:
   float sampleRate = 44100.0f;
   float cutoff = 25.0f;
@@ -0,0 +1,19 @@
+#pragma once
+
+/**
+ * @file Debug.h
+ * @brief Serial debug output macros shared by the sketch and the engine.
+ */
+
+#define DEBUG_SERIAL false // Set to false to disable Serial output
+
+#if DEBUG_SERIAL && defined(ARDUINO)
+  #include <Arduino.h>
+  #define DEBUG_PRINTF(...) Serial.printf(__VA_ARGS__)
+  #define DEBUG_PRINTLN(...) Serial.println(__VA_ARGS__)
+  #define DEBUG_BEGIN(...) Serial.begin(__VA_ARGS__)
+#else
+  #define DEBUG_PRINTF(...)
+  #define DEBUG_PRINTLN(...)
+  #define DEBUG_BEGIN(...)
+#endif
@@ -4,6 +4,7 @@
  */
 
 #include "DecayEnvelope.h"
+#include "HotPath.h"
 
 void DecayEnvelope::setSampleRate(float sr) {
   sampleRate = sr;
@@ -19,19 +20,33 @@ void DecayEnvelope::trigger() {
   y = 1.0f;
 }
 
-float DecayEnvelope::process() {
+float SYNTH_RAM_FUNC(DecayEnvelope::process)() {
   y *= coeff;
   return y;
 }
 
+void SYNTH_RAM_FUNC(DecayEnvelope::process)(float* out, int n) {
+  float level = y;
+  const float c = coeff;
+  for (int i = 0; i < n; i++) {
+    level *= c;
+    out[i] = level;
+  }
+  y = level;
+}
+
 float DecayEnvelope::getCurrentValue() const {
   return y;
 }
 
 void DecayEnvelope::calculateCoeff() {
   if (decayTime < 0.1f) decayTime = 0.1f;
+  coeff = coeffFor(decayTime, sampleRate);
+}
+
+float DecayEnvelope::coeffFor(float ms, float sr) {
   // y *= c  =>  y(t) = y(0) * c^(t*fs)
   // We want y(tau) = 1/e * y(0) ? Or just standard time constant?
   // Rosic: c = exp( -1.0 / (0.001*tau*fs) )
-  coeff = std::exp(-1.0f / (0.001f * decayTime * sampleRate));
+  return std::exp(-1.0f / (0.001f * std::max(ms, 0.1f) * sr));
 }
@@ -25,6 +25,20 @@ public:
    * @param ms Decay time in milliseconds
    */
   void setDecayTime(float ms);
+
+  /**
+   * @brief Sets the per-sample decay factor directly, e.g. one cached with
+   * coeffFor(), so a note does not pay for the exp().
+   * @param c Factor from coeffFor()
+   */
+  void setCoeff(float c) { coeff = c; }
+
+  /**
+   * @brief Per-sample decay factor for a time constant.
+   * @param ms Decay time in milliseconds
+   * @param sr Sample rate in Hz
+   */
+  static float coeffFor(float ms, float sr);
   
   /**
    * @brief Triggers the envelope (resets level to 1.0).
@@ -36,6 +50,13 @@ public:
    * @return float Current envelope level
    */
   float process();
+
+  /**
+   * @brief Processes a block of envelope samples.
+   * @param out Output buffer (n values)
+   * @param n Number of samples
+   */
+  void process(float* out, int n);
   
   /**
    * @brief Gets the current envelope value without processing.
@@ -4,6 +4,8 @@
  */
 
 #include "DisplayManager.h"
+#include <algorithm>
+#include <string.h>
 
 const unsigned char DisplayManager::image_ButtonLeft_bits[] = {0x10,0x30,0x70,0xf0,0x70,0x30,0x10};
 
@@ -12,7 +14,7 @@ const unsigned char DisplayManager::image_ButtonUp_bits[] = {0x10,0x38,0x7c,0xfe
 const unsigned char DisplayManager::image_SmallArrowDown_bits[] = {0xfe,0x7c,0x38,0x10};
 
 DisplayManager::DisplayManager()
-  : display(DISPLAY_W, DISPLAY_H, &Wire1, -1)
+  : display(DISPLAY_W, DISPLAY_H, &Wire1, -1, DISPLAY_I2C_CLOCK, DISPLAY_I2C_CLOCK)
 {
 }
 
@@ -21,6 +23,7 @@ bool DisplayManager::begin(uint8_t sda, uint8_t scl) {
   Wire1.setSDA(sda);
   Wire1.setSCL(scl);
   Wire1.begin();
+  Wire1.setClock(DISPLAY_I2C_CLOCK);
   
   // Initialize display
   if (!display.begin(SSD1306_SWITCHCAPVCC, DISPLAY_I2C_ADDR)) {
@@ -31,14 +34,86 @@ bool DisplayManager::begin(uint8_t sda, uint8_t scl) {
   display.clearDisplay();
   display.setTextColor(SSD1306_WHITE);
   display.setTextSize(1);
-  display.display();
+  display.display();  // One blocking full write at boot, the panel is blank from here on
+  memset(panel, 0, sizeof(panel));
+  ready = true;
   
   return true;
 }
 
 void DisplayManager::clear() {
   display.clearDisplay();
-  display.display();
+  busy = true;
+}
+
+bool DisplayManager::nextDirtySpan(uint8_t& page, uint8_t& col, uint8_t& len) {
+  const uint8_t* fb = display.getBuffer();
+  for (uint8_t n = 0; n < DISPLAY_PAGES; n++) {
+    uint8_t p = (scanPage + n) % DISPLAY_PAGES;
+    const uint8_t* row = fb + p * DISPLAY_W;
+    const uint8_t* shown = panel + p * DISPLAY_W;
+
+    int first = 0;
+    while (first < DISPLAY_W && row[first] == shown[first]) first++;
+    if (first == DISPLAY_W) continue;
+
+    // Up to one chunk, ending at the last changed byte in that window
+    int last = std::min(first + DISPLAY_CHUNK_BYTES, DISPLAY_W) - 1;
+    while (row[last] == shown[last]) last--;
+
+    scanPage = p;
+    page = p;
+    col = first;
+    len = last - first + 1;
+    return true;
+  }
+  return false;
+}
+
+void DisplayManager::sendSpan(uint8_t page, uint8_t col, uint8_t len) {
+  // Address window: the span's columns on a single page
+  Wire1.beginTransmission(DISPLAY_I2C_ADDR);
+  Wire1.write((uint8_t)0x00);  // Command stream
+  Wire1.write((uint8_t)SSD1306_COLUMNADDR);
+  Wire1.write(col);
+  Wire1.write((uint8_t)(col + len - 1));
+  Wire1.write((uint8_t)SSD1306_PAGEADDR);
+  Wire1.write(page);
+  Wire1.write(page);
+  Wire1.endTransmission();
+
+  const uint8_t* src = display.getBuffer() + page * DISPLAY_W + col;
+  Wire1.beginTransmission(DISPLAY_I2C_ADDR);
+  Wire1.write((uint8_t)0x40);  // Data stream
+  Wire1.write(src, len);
+  Wire1.endTransmission();
+
+  memcpy(panel + page * DISPLAY_W + col, src, len);
+}
+
+bool DisplayManager::update() {
+  if (!ready) return false;
+
+  const uint32_t start = micros();
+  uint8_t page, col, len;
+  while (nextDirtySpan(page, col, len)) {
+    // Only start a chunk that is expected to finish within the budget
+    if (micros() - start + chunkMicros > DISPLAY_UPDATE_BUDGET_US) {
+      busy = true;
+      return true;
+    }
+    uint32_t t0 = micros();
+    sendSpan(page, col, len);
+    chunkMicros = micros() - t0;
+  }
+  busy = false;
+  return false;
+}
+
+void DisplayManager::setLoadInfo(uint16_t load, uint32_t count) {
+  showLoad = true;
+  loadPermille = load;
+  underruns = count;
 }
 
 void DisplayManager::renderMenu(const Parameter& param) {
@@ -61,9 +136,15 @@ void DisplayManager::renderMenu(const Parameter& param) {
 
   display.drawBitmap(3, 28, image_SmallArrowDown_bits, 7, 4, 1);
 
+  // Audio load readout, e.g. "47% U0"
+  if (showLoad) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u%% U%lu", (unsigned)(loadPermille / 10), (unsigned long)underruns);
+    display.setCursor(DISPLAY_W - 6 * strlen(buf), 0);
+    display.print(buf);
+  }
 
-  
-  display.display();
+  busy = true;
 }
 
 void DisplayManager::renderEdit(const Parameter& param) {
@@ -86,6 +167,7 @@ void DisplayManager::renderEdit(const Parameter& param) {
   
   display.setCursor(65, 3);
   display.print(param.value);
-  
-  display.display();
+
+  // Usually only the value digits and the bar end differ from the panel
+  busy = true;
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
  * @brief OLED display management for pico-303 UI
  * 
  * Handles SSD1306 OLED display initialization and rendering of menu and edit screens.
+ * Screens are drawn into the RAM framebuffer only; update() then sends the bytes
+ * that differ from the panel in small I2C chunks, within a time budget per call.
  */
 
 #ifndef DISPLAYMANAGER_H
@@ -21,6 +23,18 @@
 #define DISPLAY_I2C_ADDR 0x3C
 #define DISPLAY_W 128
 #define DISPLAY_H 32
+#define DISPLAY_PAGES (DISPLAY_H / 8)
+
+// I2C clock for the panel (SSD1306 is specified for 400 kHz, most modules run at 1 MHz)
+#ifndef DISPLAY_I2C_CLOCK
+#define DISPLAY_I2C_CLOCK 400000
+#endif
+// Longest time one update() call may spend on the bus
+#ifndef DISPLAY_UPDATE_BUDGET_US
+#define DISPLAY_UPDATE_BUDGET_US 1000
+#endif
+// Data bytes per I2C transaction (plus one control byte, fits the Wire buffer)
+#define DISPLAY_CHUNK_BYTES 16
 
 class DisplayManager {
 public:
@@ -34,6 +48,18 @@ public:
    */
   bool begin(uint8_t sda, uint8_t scl);
   
+  /**
+   * @brief Send pending framebuffer changes to the panel.
+   * Call from every loop() iteration; returns after DISPLAY_UPDATE_BUDGET_US at most.
+   * @return true if changes are still pending
+   */
+  bool update();
+
+  /**
+   * @brief Check whether the panel still differs from the framebuffer
+   */
+  bool isBusy() const { return busy; }
+
   /**
    * @brief Render menu state (parameter name with arrows)
    * @param param Parameter to display
@@ -51,8 +77,31 @@ public:
    */
   void clear();
 
+  /**
+   * @brief Set the audio load readout shown in the menu screen's top-right corner
+   * @param loadPermille Audio core load in 1/1000 of the block budget
+   * @param underruns I2S underruns since boot
+   */
+  void setLoadInfo(uint16_t loadPermille, uint32_t underruns);
+
 private:
   Adafruit_SSD1306 display;
+
+  // Copy of what the panel currently shows (page-major, like the framebuffer)
+  uint8_t panel[DISPLAY_W * DISPLAY_PAGES];
+  uint8_t scanPage = 0;     // Page to resume scanning from
+  bool ready = false;       // begin() succeeded
+  bool busy = false;
+  uint32_t chunkMicros = 0; // Duration of the last chunk (budget estimate)
+
+  // Finds the next run of changed bytes; false if the panel is up to date
+  bool nextDirtySpan(uint8_t& page, uint8_t& col, uint8_t& len);
+  void sendSpan(uint8_t page, uint8_t col, uint8_t len);
+
+  // Load readout (drawn once setLoadInfo() has been called)
+  bool showLoad = false;
+  uint16_t loadPermille = 0;
+  uint32_t underruns = 0;
   
   // Arrow bitmaps (5x7 pixels)
   static const unsigned char image_ButtonLeft_bits[];
@@ -4,8 +4,9 @@
  */
 
 #include "Distortion.h"
+#include "HotPath.h"
 
-float Distortion::process(float input) {
+float SYNTH_RAM_FUNC(Distortion::process)(float input) {
   if (!enabled || amount <= 0.01f) return input;
 
   float drive = 1.0f + amount * 9.0f; // Map 0..1 to 1..10 drive
@@ -32,19 +33,74 @@ float Distortion::process(float input) {
   return (1.0f - mix) * input + mix * wetSignal;
 }
 
-float Distortion::processSoftClip(float x, float drive) {
+void Distortion::setOversampling(Type t, int factor) {
+  oversampling[t] = (factor == 2 || factor == 4) ? factor : 1;
+  if (t == type) oversampler.setFactor(oversampling[t]);
+}
+
+void SYNTH_RAM_FUNC(Distortion::process)(float* buf, int n) {
+  if (!isActive()) {
+    oversamplerIdle = true;
+    return;
+  }
+
+  const float drive = 1.0f + amount * 9.0f;
+  const float wet = mix;
+  const float dry = 1.0f - mix;
+
+  const int factor = oversampler.getFactor();
+  if (factor == 1) {
+    shape(buf, n, drive, dry, wet);
+    return;
+  }
+
+  // Don't ring out whatever was in the filters when the effect was last bypassed
+  if (oversamplerIdle) {
+    oversampler.reset();
+    oversamplerIdle = false;
+  }
+  for (int i = 0; i < n; i += Oversampler::kMaxBlock) {
+    int len = std::min(n - i, Oversampler::kMaxBlock);
+    float* os = oversampler.up(buf + i, len);
+    shape(os, len * factor, drive, dry, wet);
+    oversampler.down(buf + i, len);
+  }
+}
+
+void SYNTH_RAM_FUNC(Distortion::shape)(float* buf, int n, float drive, float dry, float wet) {
+  // One loop per type so each inner loop is branch-free on the mode
+  switch (type) {
+    case SOFT_CLIP:
+      for (int i = 0; i < n; i++) buf[i] = dry * buf[i] + wet * processSoftClip(buf[i], drive);
+      break;
+    case HARD_CLIP:
+      for (int i = 0; i < n; i++) buf[i] = dry * buf[i] + wet * processHardClip(buf[i], drive);
+      break;
+    case WAVEFOLDER:
+      for (int i = 0; i < n; i++) buf[i] = dry * buf[i] + wet * processWavefolder(buf[i], drive);
+      break;
+    case DIODE_CLIPPER:
+      for (int i = 0; i < n; i++) buf[i] = dry * buf[i] + wet * processDiode(buf[i], drive);
+      break;
+    case WAVENET_TUBE:
+      for (int i = 0; i < n; i++) buf[i] = dry * buf[i] + wet * processWaveNet(buf[i], drive);
+      break;
+  }
+}
+
+float SYNTH_RAM_FUNC(Distortion::processSoftClip)(float x, float drive) {
   float val = x * drive;
   // Fast sigmoid: x / (1 + |x|)
   // Much faster than std::tanh and sounds similar (slightly softer knee)
   return val / (1.0f + std::abs(val));
 }
 
-float Distortion::processHardClip(float x, float drive) {
+float SYNTH_RAM_FUNC(Distortion::processHardClip)(float x, float drive) {
   float val = x * drive;
   return std::fmax(-1.0f, std::fmin(1.0f, val));
 }
 
-float Distortion::processWavefolder(float x, float drive) {
+float SYNTH_RAM_FUNC(Distortion::processWavefolder)(float x, float drive) {
   float val = x * drive;
   if (val > 1.0f) val = 2.0f - val;
   else if (val < -1.0f) val = -2.0f - val;
@@ -53,7 +109,7 @@ float Distortion::processWavefolder(float x, float drive) {
   return std::fmax(-1.0f, std::fmin(1.0f, val));
 }
 
-float Distortion::processDiode(float x, float drive) {
+float SYNTH_RAM_FUNC(Distortion::processDiode)(float x, float drive) {
   // Asymmetric clipping simulation
   float val = x * drive;
   if (val >= 0) {
@@ -66,7 +122,7 @@ float Distortion::processDiode(float x, float drive) {
   }
 }
 
-float Distortion::processWaveNet(float x, float drive) {
+float SYNTH_RAM_FUNC(Distortion::processWaveNet)(float x, float drive) {
   // Polynomial approximation of a tube-like saturation curve
   // y = x - a*x^2 + b*x^3 ...
   // This creates even harmonics (asymmetry)
@@ -2,6 +2,8 @@
 #include <cmath>
 #include <algorithm>
 
+#include "Oversampler.h"
+
 /**
  * @file Distortion.h
  * @brief Multi-mode Distortion effect class.
@@ -11,6 +13,8 @@
  * @class Distortion
  * @brief Provides various distortion algorithms including Soft Clip, Hard Clip,
  * Wavefolder, Diode Clipper, and WaveNet Tube simulation.
+ * The block path can run each type oversampled (2x/4x) to cut aliasing from
+ * the hard-edged curves; smooth types stay at the base rate by default.
  */
 class Distortion {
 public:
@@ -25,13 +29,30 @@ public:
     WAVENET_TUBE    ///< Polynomial tube simulation
   };
 
+  static constexpr int kTypeCount = WAVENET_TUBE + 1;
+
   Distortion() {}
 
   /**
    * @brief Sets the distortion type.
    * @param t Distortion Type enum
    */
-  void setType(Type t) { type = t; }
+  void setType(Type t) {
+    type = t;
+    oversampler.setFactor(oversampling[t]);
+  }
+
+  /**
+   * @brief Sets the oversampling factor used by the block path for one type.
+   * @param t Distortion Type enum
+   * @param factor 1, 2 or 4
+   */
+  void setOversampling(Type t, int factor);
+
+  /**
+   * @brief Gets the oversampling factor of a type.
+   */
+  int getOversampling(Type t) const { return oversampling[t]; }
 
   /**
    * @brief Sets the input drive amount.
@@ -51,6 +72,9 @@ public:
    */
   void setEnabled(bool e) { enabled = e; }
 
+  /// True if process() changes the signal (enabled with a non-zero amount)
+  bool isActive() const { return enabled && amount > 0.01f; }
+
   /**
    * @brief Processes a single sample through the distortion effect.
    * @param input Audio input sample
@@ -58,12 +82,40 @@ public:
    */
   float process(float input);
 
+  /**
+   * @brief Processes a block in place. The type switch is hoisted out of the loop.
+   * Runs at the type's oversampling factor (adds a few samples of latency when > 1).
+   * @param buf Input/output buffer (n values)
+   * @param n Number of samples
+   */
+  void process(float* buf, int n);
+
+  /**
+   * @brief Skips a silent block: the oversampling filters restart from zero
+   * when the next block is processed.
+   */
+  void skip() { oversamplerIdle = true; }
+
 private:
   Type type = SOFT_CLIP;
   float amount = 0.0f;
   float mix = 1.0f;
   bool enabled = false;
 
+  // Per-type oversampling; the curves with hard corners alias the most
+  int oversampling[kTypeCount] = {
+    1,  // SOFT_CLIP
+    4,  // HARD_CLIP
+    4,  // WAVEFOLDER
+    1,  // DIODE_CLIPPER
+    2   // WAVENET_TUBE (clamps before the polynomial)
+  };
+  Oversampler oversampler;
+  bool oversamplerIdle = true;  // Filter history is stale (bypassed)
+
+  // Dry/wet shaping of a block at the current rate
+  void shape(float* buf, int n, float drive, float dry, float wet);
+
   // Internal processing functions
   float processSoftClip(float x, float drive);
   float processHardClip(float x, float drive);
@@ -0,0 +1,54 @@
+/**
+ * @file EffectArena.cpp
+ * @brief Implementation of the EffectArena class.
+ */
+
+#include "EffectArena.h"
+
+namespace {
+alignas(8) uint8_t sramStorage[EFFECT_ARENA_KB * 1024];
+}  // namespace
+
+EffectArena& EffectArena::sram() {
+  static EffectArena arena;
+  if (!arena.base) arena.begin(sramStorage, sizeof(sramStorage), false);
+  return arena;
+}
+
+EffectArena& EffectArena::psram() {
+  static EffectArena arena;
+  return arena;
+}
+
+void EffectArena::begin(void* region, size_t bytes, bool isExternal) {
+  base = (uint8_t*)region;
+  size = region ? bytes : 0;
+  used = 0;
+  external = isExternal;
+  count = 0;
+}
+
+void* EffectArena::reserve(size_t bytes, const char* owner) {
+  const size_t start = (used + 7) & ~(size_t)7;
+  if (start > size || bytes > size - start) return nullptr;
+  used = start + bytes;
+  if (count < kMaxAllocations) {
+    allocations[count].owner = owner;
+    allocations[count].bytes = (uint32_t)bytes;
+  }
+  count++;
+  return base + start;
+}
+
+void EffectArena::release(size_t m) {
+  if (m >= used) return;
+  used = m;
+  // Forget the reservations that started after the mark
+  size_t end = 0;
+  int kept = 0;
+  for (; kept < allocationCount(); kept++) {
+    end = ((end + 7) & ~(size_t)7) + allocations[kept].bytes;
+    if (end > m) break;
+  }
+  count = kept;
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#if defined(ARDUINO)
+#include <Arduino.h>  // Board variant (RP2350_PSRAM_CS)
+#endif
+
+/**
+ * @file EffectArena.h
+ * @brief Fixed memory budget for effect buffers (delay lines, loopers).
+ */
+
+// Size of the static SRAM arena. The default holds a 1 s delay line at 48 kHz
+// (188 KB of int16 frames, twice that with STEREO_DELAY_INT16=0) with a little
+// to spare; the linker fails if it does not fit next to everything else.
+// Boards with PSRAM keep the line there, so SRAM only holds its staging
+// buffers and KernelBench's scratch line (38 KB at 96 kHz).
+#ifndef EFFECT_ARENA_KB
+#if defined(RP2350_PSRAM_CS)
+#define EFFECT_ARENA_KB 48
+#elif defined(STEREO_DELAY_INT16) && !STEREO_DELAY_INT16
+#define EFFECT_ARENA_KB 384
+#else
+#define EFFECT_ARENA_KB 192
+#endif
+#endif
+
+/**
+ * @class EffectArena
+ * @brief Bump allocator over one memory region. Effects reserve their buffers
+ * from it in begin() and never free them, so the heap does not fragment and
+ * the whole effect memory use can be listed (see allocation()).
+ *
+ * sram() is a static buffer of EFFECT_ARENA_KB. psram() is empty until the
+ * sketch hands it a PSRAM region; it is marked external, so effects placed
+ * there access it in block-sized batches instead of per sample.
+ */
+class EffectArena {
+public:
+  /// Reservations tracked for the report
+  static constexpr int kMaxAllocations = 8;
+
+  struct Allocation {
+    const char* owner = nullptr;  ///< Name passed to reserve()
+    uint32_t bytes = 0;
+  };
+
+  /**
+   * @brief Assigns the region (drops all reservations).
+   * @param base Start of the region (nullptr = no memory)
+   * @param bytes Region size
+   * @param external true for slow memory (QSPI PSRAM)
+   */
+  void begin(void* base, size_t bytes, bool external);
+
+  /**
+   * @brief Reserves a block, 8-byte aligned.
+   * @param bytes Size in bytes
+   * @param owner Name for the report (a string literal)
+   * @return nullptr if the arena is full
+   */
+  void* reserve(size_t bytes, const char* owner);
+
+  /// Current fill level, for release()
+  size_t mark() const { return used; }
+
+  /**
+   * @brief Drops every reservation made after mark() returned m (scratch use,
+   * e.g. KernelBench's delay line).
+   */
+  void release(size_t m);
+
+  size_t capacity() const { return size; }
+  size_t bytesUsed() const { return used; }
+  bool isExternal() const { return external; }
+
+  /// Reservations in the report (at most kMaxAllocations)
+  int allocationCount() const { return count < kMaxAllocations ? count : kMaxAllocations; }
+  const Allocation& allocation(int i) const { return allocations[i]; }
+
+  /// The static SRAM arena (EFFECT_ARENA_KB)
+  static EffectArena& sram();
+  /// The PSRAM arena (capacity 0 without PSRAM)
+  static EffectArena& psram();
+
+private:
+  uint8_t* base = nullptr;
+  size_t size = 0;
+  size_t used = 0;
+  bool external = false;
+
+  Allocation allocations[kMaxAllocations];
+  int count = 0;
+};
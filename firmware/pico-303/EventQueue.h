@@ -0,0 +1,120 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * @file EventQueue.h
+ * @brief Lock-free single-producer/single-consumer event ring.
+ */
+
+/**
+ * @struct SynthEvent
+ * @brief A timestamped note/control event posted by the control core
+ * (MIDI callbacks, encoder) and consumed by the audio core.
+ */
+struct SynthEvent {
+  enum Type : uint8_t {
+    NOTE_ON,        ///< data1 = pitch, data2 = velocity
+    NOTE_OFF,       ///< data1 = pitch, data2 = velocity
+    CONTROL_CHANGE, ///< data1 = CC number, data2 = value
+    CLOCK,          ///< MIDI timing clock tick (24 ppqn)
+    START,          ///< MIDI Start
+    CONTINUE,       ///< MIDI Continue
+    STOP,           ///< MIDI Stop
+    SONG_POSITION,  ///< data1 = position LSB, data2 = MSB (7 bits each, in 16ths)
+    PATCH,          ///< Apply the next Patch from the patch queue (at a block start)
+    NRPN,           ///< data1 = parameter, data2 = value MSB, data3 = value LSB
+    PATTERN,        ///< Load the next pattern from the pattern queue into the sequencer
+    SEQUENCER       ///< data1 = SeqCommand, data2/data3 = value MSB/LSB
+  };
+
+  /// Step sequencer commands (data1 of SEQUENCER, also the SysEx 0x0A commands)
+  enum SeqCommand : uint8_t {
+    SEQ_STOP,   ///< Stop
+    SEQ_START,  ///< Start at step 0
+    SEQ_SYNC,   ///< value = StepSequencer::Sync
+    SEQ_TEMPO   ///< value = tempo in 1/10 BPM
+  };
+
+  uint32_t timestamp; ///< micros() at arrival
+  uint8_t type;       ///< SynthEvent::Type
+  uint8_t channel;
+  uint8_t data1;
+  uint8_t data2;
+  uint8_t data3;      ///< Third data byte (NRPN only)
+};
+
+/**
+ * @class EventQueue
+ * @brief Fixed-size SPSC ring buffer.
+ * Exactly one thread/core may call push() and exactly one may call pop()/peek().
+ * No locks are taken; head and tail are published with acquire/release ordering,
+ * so it is safe to use across the two RP2350 cores.
+ * @tparam T Item type (trivially copyable)
+ * @tparam N Capacity, must be a power of two
+ */
+template <typename T, uint32_t N>
+class EventQueue {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "EventQueue size must be a power of two");
+
+public:
+  /**
+   * @brief Appends an item (producer side).
+   * @param item Item to copy into the ring
+   * @return false if the ring is full (item not added)
+   */
+  bool push(const T& item) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= N) return false;
+    buffer[h & (N - 1)] = item;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Removes the oldest item (consumer side).
+   * @param item Receives the item
+   * @return false if the ring is empty
+   */
+  bool pop(T& item) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) return false;
+    item = buffer[t & (N - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Copies the oldest item without removing it (consumer side).
+   * @param item Receives the item
+   * @return false if the ring is empty
+   */
+  bool peek(T& item) const {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) return false;
+    item = buffer[t & (N - 1)];
+    return true;
+  }
+
+  /**
+   * @brief Discards the oldest item (consumer side), typically after peek().
+   */
+  void drop() {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t != head.load(std::memory_order_acquire)) {
+      tail.store(t + 1, std::memory_order_release);
+    }
+  }
+
+  /**
+   * @brief Checks if the ring is empty (either side, approximate).
+   */
+  bool empty() const {
+    return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+  }
+
+private:
+  T buffer[N];
+  std::atomic<uint32_t> head{0}; // Written only by the producer
+  std::atomic<uint32_t> tail{0}; // Written only by the consumer
+};
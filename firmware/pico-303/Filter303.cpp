@@ -4,20 +4,72 @@
  */
 
 #include "Filter303.h"
+#include "HotPath.h"
+#include "FixedPoint.h"
 #include <cmath>
+#include <algorithm>
+
+// Open303 cutoff -> coefficient fits, as a function of fx = wc * sqrt(0.5) / (2 pi)
+static inline float coeffB0(float fx) {
+  return (0.00045522346f + 6.1922189f * fx) / (1.0f + 12.358354f * fx + 4.4156345f * (fx * fx));
+}
+
+static inline float coeffK(float fx) {
+  return fx*(fx*(fx*(fx*(fx*(fx+7198.6997f)-5837.7917f)-476.47308f)+614.95611f)+213.87126f)+16.998792f;
+}
+
+#if FILTER303_TABLE_MODE
+float Filter303::coeffTable[Filter303::kTableSize][3];
+bool Filter303::coeffTableReady = false;
+
+void Filter303::buildCoeffTable() {
+  for (int i = 0; i < kTableSize; i++) {
+    float fx = std::exp2((float)i / kTableStepsPerOctave - (float)(kTableOctaves + 1));
+    float k = coeffK(fx);
+    coeffTable[i][0] = coeffB0(fx);
+    coeffTable[i][1] = k;
+    coeffTable[i][2] = k * 0.058823529411764705882352941176471f; // 1/17
+  }
+  coeffTableReady = true;
+}
+
+void SYNTH_RAM_FUNC(Filter303::lookupCoefficients)(float fx, float& b0, float& k, float& g) {
+  float pos = (std::log2(fx) + (float)(kTableOctaves + 1)) * kTableStepsPerOctave;
+  pos = std::fmin(std::fmax(pos, 0.0f), (float)(kTableSize - 1) - 0.001f);
+  int idx = (int)pos;
+  float frac = pos - idx;
+  const float* lo = coeffTable[idx];
+  const float* hi = coeffTable[idx + 1];
+  b0 = lo[0] + frac * (hi[0] - lo[0]);
+  k  = lo[1] + frac * (hi[1] - lo[1]);
+  g  = lo[2] + frac * (hi[2] - lo[2]);
+}
+#endif
 
 Filter303::Filter303(float sr)
   : sampleRate(sr), cutoff(1000.0f), resonance(0.0f), envMod(0.0f),
-    y1(0), y2(0), y3(0), y4(0) {}
+    y1(0), y2(0), y3(0), y4(0) {
+#if FILTER303_TABLE_MODE
+  if (!coeffTableReady) buildCoeffTable();
+#endif
+  updateCoefficients();
+}
+
+void Filter303::setSampleRate(float sr) {
+  sampleRate = sr;
+  updateCoefficients();
+}
 
 void Filter303::setCutoff(float freq) {
+  // Read per control step; the feedback HPF coefficient only depends on the sample rate
   cutoff = freq;
-  updateCoefficients();
 }
 
 void Filter303::setResonance(float res) {
   // Allow resonance > 1.0 for Devilfish self-oscillation
   resonance = std::fmax(0.0f, res);
+  // Only changes on CC, so keep the exp() out of the audio path
+  r_skew = (1.0f - std::exp(-3.0f * resonance)) / 0.9502129316f;
 }
 
 void Filter303::setEnvMod(float amount) {
@@ -28,44 +80,191 @@ void Filter303::setFMAmount(float amount) {
   fmAmount = amount;
 }
 
-float Filter303::process(float input, float env, float accentEnv, float fmInput) {
+float SYNTH_RAM_FUNC(Filter303::modulatedCutoff)(float env, float fmInput) const {
   float modAmt = std::fmin(std::fmax(envMod * env, -0.95f * cutoff), 4.0f * cutoff);
-  
+
   // Apply FM: modulate cutoff by audio signal
   if (fmAmount > 0.001f) {
     modAmt += fmAmount * fmInput * 0.5f * cutoff;
   }
 
   float modCutoff = cutoff + modAmt;
-  modCutoff = std::fmin(std::fmax(modCutoff, 5.0f), 0.45f * sampleRate);
+  return std::fmin(std::fmax(modCutoff, 5.0f), 0.45f * sampleRate);
+}
+
+void SYNTH_RAM_FUNC(Filter303::applyResonance)(float& k, float& g) const {
+  g = (g - 1.0f) * r_skew + 1.0f;
+  g = (g * (1.0f + r_skew));
+  k = k * r_skew;
+}
+
+#if FILTER303_TABLE_MODE
+void SYNTH_RAM_FUNC(Filter303::updateControlRate)(float env, float fmInput) {
+  float fx = modulatedCutoff(env, fmInput) * 0.70710678f / sampleRate;
+  float b0, k, g;
+  lookupCoefficients(fx, b0, k, g);
+  applyResonance(k, g);
+
+  // Ramp from the current coefficients to the new targets over the next interval
+  const float invInterval = 1.0f / FILTER303_CONTROL_INTERVAL;
+  b0Step = (b0 - jc_b0) * invInterval;
+  kStep = (k - jc_k) * invInterval;
+  gStep = (g - jc_g) * invInterval;
+  controlCounter = FILTER303_CONTROL_INTERVAL;
+}
+#endif
+
+float SYNTH_RAM_FUNC(Filter303::process)(float input, float env, float accentEnv, float fmInput) {
+#if FILTER303_TABLE_MODE
+  if (--controlCounter <= 0) {
+    updateControlRate(env, fmInput);
+  }
+  jc_b0 += b0Step;
+  jc_k += kStep;
+  jc_g += gStep;
+  float b0 = jc_b0;
+  float k = jc_k;
+  float g = jc_g;
+#else
+  float modCutoff = modulatedCutoff(env, fmInput);
 
   // JC303 / Open303 Logic - recalculate coefficients with modCutoff
   float wc = 2.0f * M_PI * modCutoff / sampleRate;
   float fx = wc * 0.70710678f / (2.0f * M_PI);
-  
-  float b0 = (0.00045522346f + 6.1922189f * fx) / (1.0f + 12.358354f * fx + 4.4156345f * (fx * fx));
-  float k  = fx*(fx*(fx*(fx*(fx*(fx+7198.6997f)-5837.7917f)-476.47308f)+614.95611f)+213.87126f)+16.998792f;
+
+  float b0 = coeffB0(fx);
+  float k  = coeffK(fx);
   float g  = k * 0.058823529411764705882352941176471f; // 1/17
-  
+
   // Apply resonance
-  float r_skew = (1.0f - std::exp(-3.0f * resonance)) / 0.9502129316f;
-  g = (g - 1.0f) * r_skew + 1.0f;
-  g = (g * (1.0f + r_skew));
-  k = k * r_skew;
-  
+  applyResonance(k, g);
+#endif
+
   // 1. Feedback Highpass
   float feedback = processFeedbackHPF(k * y4);
   float y0 = input - feedback;
-  
+
   // 2. 4-stage Ladder (Open303 topology)
   y1 += 2 * b0 * (y0 - y1 + y2);
   y2 +=     b0 * (y1 - 2 * y2 + y3);
   y3 +=     b0 * (y2 - 2 * y3 + y4);
   y4 +=     b0 * (y3 - 2 * y4);
-  
+
   return 2 * g * y4;
 }
 
+void SYNTH_RAM_FUNC(Filter303::process)(float* buf, const float* env, int n, float accentEnv) {
+  // Ladder and feedback HPF state stay in registers for the whole block
+  float s1 = y1, s2 = y2, s3 = y3, s4 = y4;
+  float hp = hp_state;
+  const float hpGain = 1.0f - hp_coeff;
+#if FILTER303_TABLE_MODE
+  float b0 = jc_b0, k = jc_k, g = jc_g;
+  int i = 0;
+  while (i < n) {
+    if (controlCounter <= 0) {
+      jc_b0 = b0; jc_k = k; jc_g = g;
+      updateControlRate(env[i], 0.0f);
+    }
+    int run = std::min(controlCounter, n - i);
+    controlCounter -= run;
+    const float db0 = b0Step, dk = kStep, dg = gStep;
+    for (int end = i + run; i < end; i++) {
+      b0 += db0; k += dk; g += dg;
+
+      float fbIn = k * s4;
+      hp += hpGain * (fbIn - hp);
+      float y0 = buf[i] - (fbIn - hp);
+
+      s1 += 2 * b0 * (y0 - s1 + s2);
+      s2 +=     b0 * (s1 - 2 * s2 + s3);
+      s3 +=     b0 * (s2 - 2 * s3 + s4);
+      s4 +=     b0 * (s3 - 2 * s4);
+
+      buf[i] = 2 * g * s4;
+    }
+  }
+  jc_b0 = b0; jc_k = k; jc_g = g;
+#else
+  for (int i = 0; i < n; i++) {
+    float modCutoff = modulatedCutoff(env[i], 0.0f);
+    float wc = 2.0f * M_PI * modCutoff / sampleRate;
+    float fx = wc * 0.70710678f / (2.0f * M_PI);
+
+    float b0 = coeffB0(fx);
+    float k  = coeffK(fx);
+    float g  = k * 0.058823529411764705882352941176471f; // 1/17
+    applyResonance(k, g);
+
+    float fbIn = k * s4;
+    hp += hpGain * (fbIn - hp);
+    float y0 = buf[i] - (fbIn - hp);
+
+    s1 += 2 * b0 * (y0 - s1 + s2);
+    s2 +=     b0 * (s1 - 2 * s2 + s3);
+    s3 +=     b0 * (s2 - 2 * s3 + s4);
+    s4 +=     b0 * (s3 - 2 * s4);
+
+    buf[i] = 2 * g * s4;
+  }
+#endif
+  y1 = s1; y2 = s2; y3 = s3; y4 = s4;
+  hp_state = hp;
+}
+
+#if FILTER303_TABLE_MODE
+void SYNTH_RAM_FUNC(Filter303::process)(int32_t* buf, const float* env, int n, float accentEnv) {
+  // Q5.26 state; b0 and the HPF gain are below 0.5, so they fit Q32 for
+  // mulHi(); k (up to ~100) is Q24 and 2 * g (up to ~23) is Q26.
+  int32_t s1 = fixp::toSignal(y1), s2 = fixp::toSignal(y2);
+  int32_t s3 = fixp::toSignal(y3), s4 = fixp::toSignal(y4);
+  int32_t hp = fixp::toSignal(hp_state);
+  const int32_t hpGain = fixp::toQ32(1.0f - hp_coeff);
+  int i = 0;
+  while (i < n) {
+    if (controlCounter <= 0) updateControlRate(env[i], 0.0f);
+    int run = std::min(controlCounter, n - i);
+    controlCounter -= run;
+
+    // Convert the ramp once per run; jc_* follow it in float
+    int32_t b0 = fixp::toQ32(jc_b0), db0 = fixp::toQ32(b0Step);
+    int32_t k = fixp::toQ(jc_k, 24), dk = fixp::toQ(kStep, 24);
+    int32_t g2 = fixp::toQ(2.0f * jc_g, 26), dg2 = fixp::toQ(2.0f * gStep, 26);
+    jc_b0 += b0Step * run;
+    jc_k += kStep * run;
+    jc_g += gStep * run;
+
+    for (int end = i + run; i < end; i++) {
+      b0 += db0; k += dk; g2 += dg2;
+
+      int32_t fbIn = fixp::mul<24>(k, s4);
+      hp += fixp::mulHi(fbIn - hp, hpGain);
+      int32_t y0 = buf[i] - (fbIn - hp);
+
+      s1 += 2 * fixp::mulHi(y0 - s1 + s2, b0);
+      s2 +=     fixp::mulHi(s1 - 2 * s2 + s3, b0);
+      s3 +=     fixp::mulHi(s2 - 2 * s3 + s4, b0);
+      s4 +=     fixp::mulHi(s3 - 2 * s4, b0);
+
+      buf[i] = fixp::mul<26>(g2, s4);
+    }
+  }
+  y1 = fixp::fromSignal(s1); y2 = fixp::fromSignal(s2);
+  y3 = fixp::fromSignal(s3); y4 = fixp::fromSignal(s4);
+  hp_state = fixp::fromSignal(hp);
+}
+#else
+void SYNTH_RAM_FUNC(Filter303::process)(int32_t* buf, const float* env, int n, float accentEnv) {
+  float tmp[64];
+  for (int i = 0; i < n; i += 64) {
+    int m = std::min(64, n - i);
+    fixp::fromSignal(buf + i, tmp, m);
+    process(tmp, env + i, m, accentEnv);
+    fixp::toSignal(tmp, buf + i, m);
+  }
+}
+#endif
+
 float Filter303::getCutoff() const {
   return cutoff;
 }
@@ -78,11 +277,11 @@ void Filter303::updateCoefficients() {
   // Highpass coeff (fixed 150Hz)
   float w_hp = 2.0f * M_PI * hp_cutoff;
   // Simple 1-pole coeff approximation: exp(-2pi * fc / fs)
-  hp_coeff = std::exp(-w_hp / sampleRate); 
+  hp_coeff = std::exp(-w_hp / sampleRate);
 }
 
-float Filter303::processFeedbackHPF(float input) {
+float SYNTH_RAM_FUNC(Filter303::processFeedbackHPF)(float input) {
   // Simple 1-pole Highpass: y = x - lpf(x)
   hp_state += (1.0f - hp_coeff) * (input - hp_state);
   return input - hp_state;
-}
\ No newline at end of file
+}
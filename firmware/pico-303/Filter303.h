@@ -1,10 +1,24 @@
 #pragma once
+#include <stdint.h>
 
 /**
  * @file Filter303.h
  * @brief 4-pole Diode Ladder Filter emulation (TB-303 style).
  */
 
+// Coefficient mode:
+//   0 = exact: b0/k/g are rebuilt from the modulated cutoff on every sample (reference)
+//   1 = table: b0/k/g come from a log-spaced cutoff table every FILTER303_CONTROL_INTERVAL
+//       samples and are ramped linearly in between (much cheaper per sample)
+#ifndef FILTER303_TABLE_MODE
+#define FILTER303_TABLE_MODE 1
+#endif
+
+// Samples between control-rate coefficient updates in table mode
+#ifndef FILTER303_CONTROL_INTERVAL
+#define FILTER303_CONTROL_INTERVAL 16
+#endif
+
 /**
  * @class Filter303
  * @brief Emulates the TB-303 filter response using Open303/JC303 coefficients.
@@ -14,6 +28,12 @@ class Filter303 {
 public:
   Filter303(float sampleRate = 44100.0f);
 
+  /**
+   * @brief Sets the sample rate (the cutoff stays in Hz).
+   * @param sr Sample rate in Hz
+   */
+  void setSampleRate(float sr);
+
   /**
    * @brief Sets the base cutoff frequency.
    * @param freq Frequency in Hz
@@ -46,6 +66,7 @@ public:
   
   /**
    * @brief Processes a single sample through the filter.
+   * In table mode, env and fmInput are only sampled every FILTER303_CONTROL_INTERVAL calls.
    * @param input Audio input sample
    * @param env Envelope value [0.0 ... 1.0]
    * @param accentEnv Accent envelope value [0.0 ... 1.0]
@@ -54,6 +75,27 @@ public:
    */
   float process(float input, float env, float accentEnv = 0.0f, float fmInput = 0.0f);
 
+  /**
+   * @brief Processes a block in place (no FM input).
+   * @param buf Audio input/output buffer (n values)
+   * @param env Envelope values [0.0 ... 1.0] (n values)
+   * @param n Number of samples
+   * @param accentEnv Accent envelope value for the whole block [0.0 ... 1.0]
+   */
+  void process(float* buf, const float* env, int n, float accentEnv = 0.0f);
+
+  /**
+   * @brief Fixed-point block process: same filter, Q5.26 samples (see FixedPoint.h).
+   * In table mode the coefficients still ramp at control rate in float while the
+   * ladder, the feedback HPF and the output gain run in integer arithmetic; the
+   * exact mode is the float reference and runs on a converted copy.
+   * @param buf Audio input/output buffer in Q5.26 (n values)
+   * @param env Envelope values [0.0 ... 1.0] (n values)
+   * @param n Number of samples
+   * @param accentEnv Accent envelope value for the whole block [0.0 ... 1.0]
+   */
+  void process(int32_t* buf, const float* env, int n, float accentEnv = 0.0f);
+
   float getCutoff() const;
   float getEnvMod() const;
 
@@ -67,9 +109,14 @@ private:
 
   float y1, y2, y3, y4;
 
+  // Cached resonance skew: (1 - exp(-3 * resonance)) / (1 - exp(-3))
+  float r_skew = 0.0f;
+
   void updateCoefficients();
+  float modulatedCutoff(float env, float fmInput) const;
+  void applyResonance(float& k, float& g) const;
 
-  // JC303 / Open303 Specifics
+  // JC303 / Open303 Specifics (current, ramped coefficients in table mode)
   float jc_b0 = 0.0f;
   float jc_k = 0.0f;
   float jc_g = 0.0f;
@@ -79,4 +126,23 @@ private:
   float hp_coeff = 0.0f;
   
   float processFeedbackHPF(float input);
+
+#if FILTER303_TABLE_MODE
+  // Log-spaced table of (b0, k, g) over the normalized cutoff fx = fc / fs * sqrt(0.5).
+  // Depends only on fx, so it is shared by all instances and every sample rate.
+  static constexpr int kTableOctaves = 14;        // fx from 2^-15 to 2^-1
+  static constexpr int kTableStepsPerOctave = 16;
+  static constexpr int kTableSize = kTableOctaves * kTableStepsPerOctave + 1;
+  static float coeffTable[kTableSize][3];
+  static bool coeffTableReady;
+  static void buildCoeffTable();
+  static void lookupCoefficients(float fx, float& b0, float& k, float& g);
+
+  // Control-rate ramp state
+  float b0Step = 0.0f;
+  float kStep = 0.0f;
+  float gStep = 0.0f;
+  int controlCounter = 0;
+  void updateControlRate(float env, float fmInput);
+#endif
 };
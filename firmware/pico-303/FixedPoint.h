@@ -0,0 +1,103 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file FixedPoint.h
+ * @brief Q-format helpers for the fixed-point DSP kernels.
+ *
+ * The fixed-point kernel set (SynthEngine::KERNELS_FIXED) runs the oscillator,
+ * ladder filter, post-filter HPF, VCA, delay and output soft clip on int32
+ * buffers; envelopes and distortion stay in float. On Cortex-M33 the helpers
+ * map to SMMULR, SMLAD and SSAT, elsewhere to plain C with the same results.
+ */
+
+// Default kernel set: 0 = float (reference), 1 = fixed point. Cores without an
+// FPU (Hazard3 RISC-V on the RP2350) default to fixed point.
+#ifndef SYNTH_FIXED_POINT
+#if defined(__riscv) && !defined(__riscv_flen)
+#define SYNTH_FIXED_POINT 1
+#else
+#define SYNTH_FIXED_POINT 0
+#endif
+#endif
+
+#if defined(__ARM_FEATURE_DSP) || defined(__ARM_FEATURE_SAT)
+#include <arm_acle.h>
+#endif
+
+namespace fixp {
+
+/// Fractional bits of the audio/control signal format (Q5.26, range +-32)
+constexpr int kSignalBits = 26;
+constexpr float kSignalOne = (float)(1 << kSignalBits);
+
+/// Float -> Q5.26 (the caller keeps values inside +-32)
+inline int32_t toSignal(float x) { return (int32_t)(x * kSignalOne); }
+inline float fromSignal(int32_t x) { return (float)x * (1.0f / kSignalOne); }
+
+/// Float coefficient -> Q(fracBits), fracBits <= 31, saturated to the int32 range
+inline int32_t toQ(float x, int fracBits) {
+  float v = x * (float)(1u << fracBits);
+  if (v >= 2147483520.0f) return INT32_MAX;  // Largest float below 2^31
+  if (v <= -2147483648.0f) return INT32_MIN;
+  return (int32_t)v;
+}
+
+/// Coefficient in [0, 0.5) -> Q32, for mulHi()
+inline int32_t toQ32(float x) { return (int32_t)(x * 4294967296.0f); }
+
+/// Block conversions between the float and the Q5.26 scratch buffers
+inline void toSignal(const float* in, int32_t* out, int n) {
+  for (int i = 0; i < n; i++) out[i] = toSignal(in[i]);
+}
+
+inline void fromSignal(const int32_t* in, float* out, int n) {
+  for (int i = 0; i < n; i++) out[i] = fromSignal(in[i]);
+}
+
+/**
+ * @brief Rounded high word of a * b (SMMULR).
+ * With b in Q32 (a coefficient below 0.5), this is a * b in a's format.
+ */
+inline int32_t mulHi(int32_t a, int32_t b) {
+#if defined(__ARM_FEATURE_DSP)
+  int32_t r;
+  __asm__("smmulr %0, %1, %2" : "=r"(r) : "r"(a), "r"(b));
+  return r;
+#else
+  return (int32_t)(((int64_t)a * b + 0x80000000LL) >> 32);
+#endif
+}
+
+/// (a * b) >> Shift with a 64-bit intermediate (SMULL and two shifts)
+template <int Shift>
+inline int32_t mul(int32_t a, int32_t b) {
+  return (int32_t)(((int64_t)a * b) >> Shift);
+}
+
+/// Saturates to a signed Bits-wide integer (SSAT)
+template <int Bits>
+inline int32_t sat(int32_t x) {
+#if defined(__ARM_FEATURE_SAT)
+  return __ssat(x, Bits);
+#else
+  constexpr int32_t hi = (1 << (Bits - 1)) - 1;
+  return x > hi ? hi : (x < -hi - 1 ? -hi - 1 : x);
+#endif
+}
+
+/// Two 16x16 products of the packed halfwords, summed (SMLAD with acc = 0)
+inline int32_t dot16(uint32_t x, uint32_t y) {
+#if defined(__ARM_FEATURE_DSP)
+  return __smlad(x, y, 0);
+#else
+  return (int16_t)(x & 0xFFFF) * (int16_t)(y & 0xFFFF) + (int16_t)(x >> 16) * (int16_t)(y >> 16);
+#endif
+}
+
+/// Packs two int16 values into one word, lo in the low half
+inline uint32_t pack16(int32_t lo, int32_t hi) {
+  return (uint32_t)(uint16_t)lo | ((uint32_t)hi << 16);
+}
+
+}  // namespace fixp
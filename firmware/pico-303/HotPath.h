@@ -0,0 +1,30 @@
+#pragma once
+
+/**
+ * @file HotPath.h
+ * @brief Optional SRAM placement of the audio render path.
+ *
+ * By default all code runs from XIP flash through the flash cache, so UI
+ * (GFX, I2C) and TinyUSB code running on core 0 can evict the render loop
+ * and add a cache refill to the next block. With SYNTH_RAM_FUNCS=1 the
+ * functions marked with SYNTH_RAM_FUNC (render loop, every per-block DSP
+ * process() and the I2S interrupt) are linked into .time_critical, which the
+ * boot code copies to SRAM, and the constant tables read per sample are
+ * copied along with them. The host build ignores both macros.
+ */
+
+// 1 = render path and its tables in SRAM (about 20 KB), 0 = run from flash
+#ifndef SYNTH_RAM_FUNCS
+#define SYNTH_RAM_FUNCS 0
+#endif
+
+#if SYNTH_RAM_FUNCS && (defined(ARDUINO_ARCH_RP2040) || defined(PICO_BUILD))
+#include <pico.h>
+/// Function definition in SRAM: void SYNTH_RAM_FUNC(Class::name)(args) { ... }
+#define SYNTH_RAM_FUNC(name) __not_in_flash_func(name)
+/// Constant data in SRAM: SYNTH_RAM_DATA("group") const T table[] = { ... };
+#define SYNTH_RAM_DATA(group) __not_in_flash(group)
+#else
+#define SYNTH_RAM_FUNC(name) name
+#define SYNTH_RAM_DATA(group)
+#endif
@@ -0,0 +1,196 @@
+/**
+ * @file I2SRing.cpp
+ * @brief Implementation of the I2SRing class.
+ */
+
+#include "I2SRing.h"
+#include "HotPath.h"
+#include <hardware/clocks.h>
+#include <hardware/dma.h>
+#include <hardware/gpio.h>
+#include <hardware/irq.h>
+#include <hardware/pio.h>
+#include <pico/time.h>
+#include <algorithm>
+
+I2SRing* I2SRing::instance = nullptr;
+
+namespace {
+
+// I2S transmitter, 32 PIO cycles per channel slot (pico-extras audio_i2s).
+// Side-set bit 0 = BCLK, bit 1 = LRCLK; the data bit changes on the falling
+// BCLK edge and LRCLK one bit before the MSB. The high half of each word is
+// the right channel, so L/R interleaved int16 frames go out as they are.
+const uint16_t kI2SProgram[] = {
+  0x7001,  //  0: out    pins, 1         side 2   (wrap target)
+  0x1840,  //  1: jmp    x--, 0          side 3
+  0x6001,  //  2: out    pins, 1         side 0
+  0xe82e,  //  3: set    x, 14           side 1
+  0x6001,  //  4: out    pins, 1         side 0
+  0x0844,  //  5: jmp    x--, 4          side 1
+  0x7001,  //  6: out    pins, 1         side 2
+  0xf82e,  //  7: set    x, 14           side 3   (wrap, entry point)
+};
+constexpr uint kWrapTarget = 0;
+constexpr uint kWrap = 7;
+constexpr uint kEntryPoint = 7;
+constexpr uint kCyclesPerFrame = 64;
+
+const pio_program_t kI2SPioProgram = { kI2SProgram, sizeof(kI2SProgram) / sizeof(kI2SProgram[0]), -1 };
+
+}  // namespace
+
+bool I2SRing::begin(int sampleRate, int bclkPin, int dataPin, int framesPerBlock, int blocks) {
+  if (instance || blocks < 2) return false;
+  this->sampleRate = sampleRate;
+  blockFrames = framesPerBlock;
+  blockCount = blocks;
+  frames.assign(blockFrames * blockCount, 0u);
+  if (frames.empty()) return false;
+
+  PIO pio = pio0;
+  int sm = pio_claim_unused_sm(pio, false);
+  if (sm < 0 || !pio_can_add_program(pio, &kI2SPioProgram)) return false;
+  uint offset = pio_add_program(pio, &kI2SPioProgram);
+  stateMachine = sm;
+
+  pio_gpio_init(pio, dataPin);
+  pio_gpio_init(pio, bclkPin);
+  pio_gpio_init(pio, bclkPin + 1);
+  pio_sm_set_consecutive_pindirs(pio, sm, dataPin, 1, true);
+  pio_sm_set_consecutive_pindirs(pio, sm, bclkPin, 2, true);
+
+  pio_sm_config c = pio_get_default_sm_config();
+  sm_config_set_wrap(&c, offset + kWrapTarget, offset + kWrap);
+  sm_config_set_sideset(&c, 2, false, false);
+  sm_config_set_out_pins(&c, dataPin, 1);
+  sm_config_set_sideset_pins(&c, bclkPin);
+  sm_config_set_out_shift(&c, false, true, 32);  // MSB first, autopull every frame
+  sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_TX);
+  sm_config_set_clkdiv(&c, (float)clock_get_hz(clk_sys) / ((float)sampleRate * kCyclesPerFrame));
+  pio_sm_init(pio, sm, offset + kEntryPoint, &c);
+
+  for (int i = 0; i < 2; i++) {
+    dmaChannel[i] = dma_claim_unused_channel(false);
+    if (dmaChannel[i] < 0) return false;
+  }
+  // Channel i plays the even/odd blocks and chains to the other one
+  for (int i = 0; i < 2; i++) {
+    dma_channel_config dc = dma_channel_get_default_config(dmaChannel[i]);
+    channel_config_set_transfer_data_size(&dc, DMA_SIZE_32);
+    channel_config_set_read_increment(&dc, true);
+    channel_config_set_write_increment(&dc, false);
+    channel_config_set_dreq(&dc, pio_get_dreq(pio, sm, true));
+    channel_config_set_chain_to(&dc, dmaChannel[1 - i]);
+    dma_channel_configure(dmaChannel[i], &dc, &pio->txf[sm], block(i), blockFrames, false);
+    dma_channel_set_irq0_enabled(dmaChannel[i], true);
+  }
+
+  // Blocks 0 and 1 go out silent while the first ones are rendered
+  played = 0;
+  filled = 2;
+  instance = this;
+  irq_add_shared_handler(DMA_IRQ_0, dmaIrq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+  irq_set_enabled(DMA_IRQ_0, true);
+
+  dma_channel_start(dmaChannel[0]);
+  pio_sm_set_enabled(pio, sm, true);
+  return true;
+}
+
+int16_t* SYNTH_RAM_FUNC(I2SRing::acquire)() {
+  const uint32_t p = played;
+  if ((int32_t)(filled - (p + 1)) < 0) filled = p + 1;  // Fell behind: skip what was already played
+  if (filled - p >= (uint32_t)blockCount) return nullptr;
+  return (int16_t*)block(filled);
+}
+
+int I2SRing::freeBlocks() const {
+  int queued = (int)(filled - played);
+  return queued < blockCount ? blockCount - queued : 0;
+}
+
+int SYNTH_RAM_FUNC(I2SRing::queuedFrames)() const {
+  // Block p plays on DMA channel p & 1; re-read if its interrupt moved on meanwhile
+  uint32_t p, remaining;
+  do {
+    p = played;
+    remaining = dma_channel_hw_addr(dmaChannel[p & 1])->transfer_count & 0x0FFFFFFFu;
+  } while (p != played);
+  const int behind = std::max((int)(filled - p) - 1, 0);
+  return (int)remaining + behind * blockFrames;
+}
+
+void I2SRing::setMarkerPin(int pin) {
+  markerPin = pin;
+  if (pin < 0) return;
+  gpio_init(pin);
+  gpio_set_dir(pin, GPIO_OUT);
+  gpio_put(pin, 0);
+}
+
+void SYNTH_RAM_FUNC(I2SRing::mark)(int frame) {
+  if (markerPin < 0 || markerFrame >= 0) return;
+  markerBlock = filled;
+  markerFrame = std::clamp(frame, 0, blockFrames - 1);
+}
+
+bool I2SRing::getUnderflow() {
+  bool u = underflow;
+  underflow = false;
+  return u;
+}
+
+void I2SRing::pause() {
+  if (stateMachine >= 0) pio_sm_set_enabled(pio0, stateMachine, false);
+}
+
+void I2SRing::resume() {
+  if (stateMachine >= 0) pio_sm_set_enabled(pio0, stateMachine, true);
+}
+
+void SYNTH_RAM_FUNC(I2SRing::dmaIrq)() {
+  I2SRing* ring = instance;
+  for (int i = 0; i < 2; i++) {
+    const int ch = ring->dmaChannel[i];
+    if (dma_channel_get_irq0_status(ch)) {
+      dma_channel_acknowledge_irq0(ch);
+      ring->blockDone(ch);
+    }
+  }
+}
+
+void SYNTH_RAM_FUNC(I2SRing::blockDone)(int channel) {
+  // The other channel has started block p; this one follows with p + 1
+  const uint32_t p = played + 1;
+  played = p;
+  if ((int32_t)(filled - (p + 1)) < 0) underflow = true;
+  dma_channel_set_read_addr(channel, block(p + 1), false);
+  if (markerPin >= 0) updateMarker(p);
+  if (transmitFn) transmitFn();
+}
+
+void SYNTH_RAM_FUNC(I2SRing::updateMarker)(uint32_t startedBlock) {
+  if (markerFrame < 0) return;
+  const int32_t age = (int32_t)(startedBlock - markerBlock);
+  if (age < 0) return;
+  if (markerHigh) {
+    if (age < 2) return;
+    gpio_put(markerPin, 0);
+    markerHigh = false;
+    markerFrame = -1;
+  } else if (age == 0) {
+    // The marked block starts now; its frame follows frame / sampleRate later
+    markerHigh = true;
+    const uint32_t us = (uint32_t)((uint64_t)markerFrame * 1000000u / sampleRate);
+    if (us == 0) gpio_put(markerPin, 1);
+    else add_alarm_in_us(us, raiseMarker, this, true);
+  } else {
+    markerFrame = -1;  // Its block was skipped (underflow)
+  }
+}
+
+int64_t SYNTH_RAM_FUNC(I2SRing::raiseMarker)(int32_t alarm, void* ring) {
+  gpio_put(((I2SRing*)ring)->markerPin, 1);
+  return 0;
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+/**
+ * @file I2SRing.h
+ * @brief Zero-copy I2S output: the audio core renders straight into DMA buffers.
+ */
+
+/**
+ * @class I2SRing
+ * @brief 16-bit stereo I2S on a PIO state machine, fed by two chained DMA
+ * channels from a ring of blocks (ping-pong with two, N-deep with more).
+ * Unlike the I2S library there is no copy into its own buffers: acquire()
+ * hands out the next free block, the caller renders into it and commit()s it.
+ * Each completed block raises the DMA interrupt, which re-arms its channel
+ * two blocks ahead and wakes the audio core, so rendering starts on the DMA
+ * edge instead of polling availableForWrite().
+ *
+ * Call begin() from the core that renders (the DMA interrupt is enabled there).
+ * Pins follow the Pico Audio Pack / I2S library wiring: LRCLK = BCLK + 1.
+ */
+class I2SRing {
+public:
+  /**
+   * @brief Claims a PIO state machine and two DMA channels and starts output
+   * (the blocks start out silent).
+   * @param sampleRate Sample rate in Hz
+   * @param bclkPin Bit clock pin (LRCLK is the next pin)
+   * @param dataPin Data out pin
+   * @param framesPerBlock Stereo frames per block
+   * @param blocks Blocks in the ring (2 = ping-pong), latency blocks * framesPerBlock
+   * @return false if no state machine, DMA channel or memory was available
+   */
+  bool begin(int sampleRate, int bclkPin, int dataPin, int framesPerBlock, int blocks);
+
+  /**
+   * @brief Next block to render into. The DMA does not read it before commit().
+   * @return L/R interleaved frames, or nullptr while every free block is filled
+   */
+  int16_t* acquire();
+
+  /// Queues the block from acquire() for playback
+  void commit() { filled = filled + 1; }
+
+  /// Blocks that can be rendered now
+  int freeBlocks() const;
+
+  /**
+   * @brief Frames the DMA plays before the block from acquire(): what is left
+   * of the block playing now plus the committed blocks behind it.
+   */
+  int queuedFrames() const;
+
+  /**
+   * @brief Sets the pin mark() pulses (configured as an output), -1 = none.
+   */
+  void setMarkerPin(int pin);
+
+  /**
+   * @brief Raises the marker pin when a frame of the block from acquire()
+   * leaves the DMA, and lowers it about a block later (latency measurement).
+   * One mark at a time: marks made while one is pending are ignored.
+   * @param frame Frame in the block
+   */
+  void mark(int frame);
+
+  /**
+   * @brief Sets a function called from the DMA interrupt after every block.
+   */
+  void onTransmit(void (*fn)()) { transmitFn = fn; }
+
+  /**
+   * @brief True if the DMA started a block that was not committed yet
+   * (it replays that slot's old contents) since the last call.
+   */
+  bool getUnderflow();
+
+  /**
+   * @brief Holds the output (the state machine stops, the DMA waits for it).
+   * Use around a flash erase: the DMA interrupt cannot re-arm the channels
+   * while the audio core is parked, so they would run past their blocks.
+   */
+  void pause();
+
+  /// Restarts the output after pause()
+  void resume();
+
+private:
+  static void dmaIrq();
+  static int64_t raiseMarker(int32_t alarm, void* ring);
+  void blockDone(int channel);
+  void updateMarker(uint32_t startedBlock);
+
+  std::vector<uint32_t> frames;  // blockCount blocks, one packed L/R frame per word
+  int sampleRate = 0;
+  int blockFrames = 0;
+  int blockCount = 0;
+  int dmaChannel[2] = { -1, -1 };
+  int stateMachine = -1;  // On pio0
+
+  // Absolute block numbers; block b lives in slot b % blockCount.
+  // played: blocks the DMA has finished (interrupt), filled: blocks committed.
+  volatile uint32_t played = 0;
+  volatile uint32_t filled = 0;
+  volatile bool underflow = false;
+  void (*transmitFn)() = nullptr;
+
+  // mark(): block number and frame of the pending mark (frame -1 = none)
+  int markerPin = -1;
+  volatile uint32_t markerBlock = 0;
+  volatile int markerFrame = -1;
+  bool markerHigh = false;
+
+  uint32_t* block(uint32_t b) { return &frames[(b % blockCount) * blockFrames]; }
+
+  static I2SRing* instance;  // Owner of the DMA interrupt
+};
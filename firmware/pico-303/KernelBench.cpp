@@ -0,0 +1,123 @@
+/**
+ * @file KernelBench.cpp
+ * @brief Implementation of the KernelBench class.
+ */
+
+#include "KernelBench.h"
+#include "FixedPoint.h"
+#include <vector>
+
+namespace {
+
+// Short delay line: same per-sample work as the full one, a fraction of the RAM
+constexpr float kBenchDelayMs = 100.0f;
+
+// Times fn() kRuns times and keeps the fastest run
+template <typename F>
+uint32_t bestOf(uint32_t (*clock)(), F fn) {
+  uint32_t best = UINT32_MAX;
+  for (int r = 0; r < KernelBench::kRuns; r++) {
+    uint32_t t0 = clock();
+    fn();
+    uint32_t dt = clock() - t0;
+    if (dt < best) best = dt;
+  }
+  return best;
+}
+
+}  // namespace
+
+bool KernelBench::run(uint32_t (*clock)(), int sampleRate) {
+  constexpr int n = kBlock;
+  std::vector<float> buf(n), env(n), left(n), right(n);
+  std::vector<int32_t> bufQ(n), leftQ(n), rightQ(n);
+  std::vector<int16_t> pcm(2 * n);
+
+  Oscillator osc;
+  osc.setSampleRate(sampleRate);
+  osc.setMethod(Oscillator::POLYBLEP);
+  osc.setMode(true);
+  osc.setSubBlend(0.5f);
+  osc.glideTo(110.0f, 0.0f);
+
+#if OSCILLATOR_WAVETABLE_SUPPORT
+  Oscillator tableOsc = osc;
+  tableOsc.setMethod(Oscillator::WAVETABLE);
+#endif
+
+  Filter303 filter((float)sampleRate);
+  filter.setCutoff(800.0f);
+  filter.setResonance(0.8f);
+  filter.setEnvMod(1500.0f);
+
+  // The bench line is scratch: its arena space is handed back at the end
+  EffectArena& arena = EffectArena::sram();
+  const size_t arenaMark = arena.mark();
+  StereoDelay delay(kBenchDelayMs);
+  if (!delay.begin((float)sampleRate, arena)) {
+    arena.release(arenaMark);
+    return false;
+  }
+  delay.setTimeSamplesL(delay.getMaxDelaySamples() / 2);
+  delay.setTimeSamplesR(delay.getMaxDelaySamples() / 3);
+
+  OutputStage output;
+
+  for (int i = 0; i < n; i++) env[i] = 1.0f - (float)i / n;
+
+  for (int s = 0; s < 2; s++) {
+    const bool fixed = s == SynthEngine::KERNELS_FIXED;
+    uint32_t* t = best[s];
+
+    // The kernels run on each other's output, so every stage sees a real signal
+    t[KERNEL_OSC] = bestOf(clock, [&] {
+      if (fixed) osc.process(bufQ.data(), n);
+      else osc.process(buf.data(), n);
+    });
+#if OSCILLATOR_WAVETABLE_SUPPORT
+    wavetable[s] = bestOf(clock, [&] {
+      if (fixed) tableOsc.process(bufQ.data(), n);
+      else tableOsc.process(buf.data(), n);
+    });
+#endif
+    t[KERNEL_LADDER] = bestOf(clock, [&] {
+      if (fixed) filter.process(bufQ.data(), env.data(), n);
+      else filter.process(buf.data(), env.data(), n);
+    });
+    t[KERNEL_DELAY] = bestOf(clock, [&] {
+      if (fixed) {
+        for (int i = 0; i < n; i++) leftQ[i] = rightQ[i] = bufQ[i];
+        delay.process(leftQ.data(), rightQ.data(), n);
+      } else {
+        for (int i = 0; i < n; i++) left[i] = right[i] = buf[i];
+        delay.process(left.data(), right.data(), n);
+      }
+    });
+    t[KERNEL_SOFT_CLIP] = bestOf(clock, [&] {
+      if (fixed) output.process(leftQ.data(), rightQ.data(), pcm.data(), n);
+      else output.process(left.data(), right.data(), pcm.data(), n);
+    });
+  }
+  arena.release(arenaMark);
+  return true;
+}
+
+uint32_t KernelBench::total(SynthEngine::KernelSet s) const {
+  uint32_t sum = 0;
+  for (int k = 0; k < KERNEL_COUNT; k++) sum += best[s][k];
+  return sum;
+}
+
+SynthEngine::KernelSet KernelBench::fastest() const {
+  return total(SynthEngine::KERNELS_FIXED) < total(SynthEngine::KERNELS_FLOAT)
+           ? SynthEngine::KERNELS_FIXED : SynthEngine::KERNELS_FLOAT;
+}
+
+const char* KernelBench::kernelName(Kernel k) {
+  static const char* const names[KERNEL_COUNT] = { "osc", "ladder", "softclip", "delay" };
+  return names[k];
+}
+
+const char* KernelBench::setName(SynthEngine::KernelSet s) {
+  return s == SynthEngine::KERNELS_FIXED ? "fixed" : "float";
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <stdint.h>
+
+#include "SynthEngine.h"
+
+/**
+ * @file KernelBench.h
+ * @brief Startup self-benchmark of the float and fixed-point DSP kernels.
+ */
+
+/**
+ * @class KernelBench
+ * @brief Times every hot kernel in both SynthEngine kernel sets on the calling
+ * core, on scratch objects (the engine's own state is not touched).
+ * Run it on the audio core before audio starts: the float set is the right
+ * choice on the M33 cores, the fixed-point set on Hazard3, which has no FPU.
+ */
+class KernelBench {
+public:
+  enum Kernel {
+    KERNEL_OSC,        ///< Oscillator (PolyBLEP square + sub)
+    KERNEL_LADDER,     ///< Ladder filter
+    KERNEL_SOFT_CLIP,  ///< Output soft clip and int16 conversion
+    KERNEL_DELAY,      ///< Stereo delay
+    KERNEL_COUNT
+  };
+
+  /// Samples per timed block
+  static constexpr int kBlock = SynthEngine::kMaxFrames;
+
+  /// Timed blocks per kernel; the fastest one is kept
+  static constexpr int kRuns = 8;
+
+  /**
+   * @brief Runs the benchmark.
+   * @param clock Free-running tick counter (e.g. profileTicks)
+   * @param sampleRate Sample rate in Hz
+   * @return false if the scratch buffers could not be allocated
+   */
+  bool run(uint32_t (*clock)(), int sampleRate);
+
+  /// Best ticks per kBlock-sample block of a kernel
+  uint32_t ticks(Kernel k, SynthEngine::KernelSet s) const { return best[s][k]; }
+
+  /// Best ticks per block of the oscillator with the WAVETABLE method (not part of
+  /// total(); 0 without OSCILLATOR_WAVETABLE_SUPPORT)
+  uint32_t wavetableTicks(SynthEngine::KernelSet s) const { return wavetable[s]; }
+
+  /// Sum over all kernels of a set
+  uint32_t total(SynthEngine::KernelSet s) const;
+
+  /// The set with the lower total
+  SynthEngine::KernelSet fastest() const;
+
+  static const char* kernelName(Kernel k);
+  static const char* setName(SynthEngine::KernelSet s);
+
+private:
+  uint32_t best[2][KERNEL_COUNT] = {};
+  uint32_t wavetable[2] = {};
+};
@@ -0,0 +1,73 @@
+/**
+ * @file LatencyProbe.cpp
+ * @brief Implementation of the LatencyProbe class.
+ */
+
+#include "LatencyProbe.h"
+#include "HotPath.h"
+#include <algorithm>
+#include <stdlib.h>
+
+LatencyProbe::LatencyProbe(uint32_t latencyBinUs, uint32_t jitterBinUs) {
+  report.latencyBinUs = std::max<uint32_t>(latencyBinUs, 1);
+  report.jitterBinUs = std::max<uint32_t>(jitterBinUs, 1);
+}
+
+void SYNTH_RAM_FUNC(LatencyProbe::beginBlock)(uint32_t nowMicros, int queuedFrames) {
+  blockStart = nowMicros;
+  queued = std::max(queuedFrames, 0);
+  if (!resetRequested.exchange(false, std::memory_order_relaxed)) return;
+
+  const uint32_t seq = sequence.load(std::memory_order_relaxed);
+  sequence.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  const uint32_t latencyBinUs = report.latencyBinUs, jitterBinUs = report.jitterBinUs;
+  report = Report();
+  report.latencyBinUs = latencyBinUs;
+  report.jitterBinUs = jitterBinUs;
+  sumUs = 0;
+  lastUs = -1;
+  std::atomic_thread_fence(std::memory_order_release);
+  sequence.store(seq + 2, std::memory_order_relaxed);
+}
+
+void SYNTH_RAM_FUNC(LatencyProbe::applied)(uint32_t arrivalMicros, int offset) {
+  const uint32_t outputMicros = blockStart + (uint32_t)((uint64_t)(queued + offset) * 1000000u / sampleRate);
+  const int32_t us = std::max((int32_t)(outputMicros - arrivalMicros), (int32_t)0);
+
+  const uint32_t seq = sequence.load(std::memory_order_relaxed);
+  sequence.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  const uint32_t q = (uint32_t)queued;
+  if (report.events == 0) {
+    report.minUs = report.maxUs = us;
+    report.minQueuedFrames = report.maxQueuedFrames = q;
+  }
+  report.minUs = std::min(report.minUs, (uint32_t)us);
+  report.maxUs = std::max(report.maxUs, (uint32_t)us);
+  report.minQueuedFrames = std::min(report.minQueuedFrames, q);
+  report.maxQueuedFrames = std::max(report.maxQueuedFrames, q);
+  report.events++;
+  sumUs += us;
+  report.meanUs = (uint32_t)(sumUs / report.events);
+
+  report.latency[std::min<uint32_t>(us / report.latencyBinUs, kBins - 1)]++;
+  if (lastUs >= 0) {
+    report.jitter[std::min<uint32_t>(abs(us - lastUs) / report.jitterBinUs, kBins - 1)]++;
+  }
+  lastUs = us;
+
+  std::atomic_thread_fence(std::memory_order_release);
+  sequence.store(seq + 2, std::memory_order_relaxed);
+}
+
+void LatencyProbe::read(Report& out) const {
+  uint32_t before, after;
+  do {
+    before = sequence.load(std::memory_order_acquire);
+    out = report;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = sequence.load(std::memory_order_relaxed);
+  } while ((before & 1) || before != after);
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * @file LatencyProbe.h
+ * @brief MIDI-to-DAC latency and jitter histograms (LATENCY_PROBE builds).
+ */
+
+/**
+ * @class LatencyProbe
+ * @brief Measures how long a note-on takes from its MIDI handler to the DAC.
+ *
+ * For every note-on applied in fillAudioBlock() the audio core records when
+ * the handler timestamped it and the sample offset it landed on. Together
+ * with the frames already queued in the I2S buffers when the block was
+ * started, that gives the time its first sample leaves the DAC:
+ *
+ *   latency = blockStart + (queuedFrames + offset) / sampleRate - arrival
+ *
+ * It starts at the handler, so the USB transfer and the time a packet waits
+ * for MIDI.read() are not included; it covers the one-block event window,
+ * the block quantisation and the I2S queue depth.
+ *
+ * Jitter is the difference between the latencies of consecutive note-ons.
+ * Both histograms have kBins bins; the last one also counts everything above.
+ *
+ * The audio core writes, the control core reads through a sequence counter
+ * (as AudioMonitor), so a report is never torn.
+ */
+class LatencyProbe {
+public:
+  static constexpr int kBins = 32;
+
+  struct Report {
+    uint32_t events = 0;           ///< Note-ons measured since the last reset
+    uint32_t minUs = 0;            ///< Lowest latency
+    uint32_t maxUs = 0;            ///< Highest latency
+    uint32_t meanUs = 0;           ///< Mean latency
+    uint32_t minQueuedFrames = 0;  ///< Fewest frames queued ahead of a measured note
+    uint32_t maxQueuedFrames = 0;  ///< Most frames queued ahead of a measured note
+    uint32_t latencyBinUs = 0;     ///< Width of a latency bin
+    uint32_t jitterBinUs = 0;      ///< Width of a jitter bin
+    uint32_t latency[kBins] = {};  ///< Latency histogram
+    uint32_t jitter[kBins] = {};   ///< Jitter histogram
+  };
+
+  /**
+   * @param latencyBinUs Width of a latency bin in µs
+   * @param jitterBinUs Width of a jitter bin in µs
+   */
+  LatencyProbe(uint32_t latencyBinUs, uint32_t jitterBinUs);
+
+  void setSampleRate(int sr) { sampleRate = sr; }
+
+  /**
+   * @brief Notes the start of a block (audio core, before fillAudioBlock()).
+   * @param nowMicros micros() when the block starts rendering
+   * @param queuedFrames Frames the I2S output plays before this block
+   */
+  void beginBlock(uint32_t nowMicros, int queuedFrames);
+
+  /**
+   * @brief Records a note-on applied in the current block (audio core).
+   * @param arrivalMicros Event timestamp from the MIDI handler
+   * @param offset Sample offset in the block it was applied at
+   */
+  void applied(uint32_t arrivalMicros, int offset);
+
+  /// Copies the histograms (control core)
+  void read(Report& out) const;
+
+  /// Asks the audio core to clear the histograms at the next block (control core)
+  void requestReset() { resetRequested.store(true, std::memory_order_relaxed); }
+
+private:
+  Report report;
+  uint64_t sumUs = 0;
+  int32_t lastUs = -1;  // Latency of the previous note-on (-1 = none)
+
+  int sampleRate = 44100;
+  uint32_t blockStart = 0;
+  int queued = 0;
+
+  std::atomic<bool> resetRequested{false};
+  std::atomic<uint32_t> sequence{0};  // Odd = being written
+};
@@ -4,6 +4,8 @@
  */
 
 #include "LeakyIntegrator.h"
+#include "HotPath.h"
+#include "FixedPoint.h"
 
 void LeakyIntegrator::setSampleRate(float sr) {
   sampleRate = sr;
@@ -15,11 +17,31 @@ void LeakyIntegrator::setTimeConstant(float tauMs) {
   calculateCoeff();
 }
 
-float LeakyIntegrator::process(float in) {
+float SYNTH_RAM_FUNC(LeakyIntegrator::process)(float in) {
   y += c * (in - y);
   return y;
 }
 
+void SYNTH_RAM_FUNC(LeakyIntegrator::process)(float* buf, int n) {
+  float state = y;
+  const float coeff = c;
+  for (int i = 0; i < n; i++) {
+    state += coeff * (buf[i] - state);
+    buf[i] = state;
+  }
+  y = state;
+}
+
+void SYNTH_RAM_FUNC(LeakyIntegrator::process)(int32_t* buf, int n) {
+  int32_t state = fixp::toSignal(y);
+  const int32_t coeff = fixp::toQ(c, 31);  // c <= 1.0 saturates just below it
+  for (int i = 0; i < n; i++) {
+    state += fixp::mul<31>(buf[i] - state, coeff);
+    buf[i] = state;
+  }
+  y = fixp::fromSignal(state);
+}
+
 void LeakyIntegrator::reset() {
   y = 0.0f;
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include <cmath>
 #include <algorithm>
+#include <stdint.h>
 
 /**
  * @file LeakyIntegrator.h
@@ -32,6 +33,20 @@ public:
    * @return float Filtered output value
    */
   float process(float in);
+
+  /**
+   * @brief Processes a block in place.
+   * @param buf Input/output buffer (n values)
+   * @param n Number of samples
+   */
+  void process(float* buf, int n);
+
+  /**
+   * @brief Processes a Q5.26 block in place (see FixedPoint.h).
+   * @param buf Input/output buffer (n values)
+   * @param n Number of samples
+   */
+  void process(int32_t* buf, int n);
   
   /**
    * @brief Resets the integrator state to 0.
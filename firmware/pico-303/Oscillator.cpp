@@ -4,15 +4,77 @@
  */
 
 #include "Oscillator.h"
+#include "HotPath.h"
+#include "FixedPoint.h"
+#include "ControlCurves.h"
 #include <cmath>
 #include <algorithm>
+#if OSCILLATOR_WAVETABLE_SUPPORT
+#include <vector>
+#endif
+
+static constexpr float kPhaseScale = 4294967296.0f;       // 2^32 (phase units per cycle)
+static constexpr float kInvPhaseScale = 1.0f / 4294967296.0f;
+
+#if OSCILLATOR_WAVETABLE_SUPPORT
+static constexpr float kTableOne = 16384.0f;                // Q14 wavetable entries
+static constexpr int kFracBits = 32 - Oscillator::kTableBits; // Phase bits between entries
+
+int16_t Oscillator::sawTable[Oscillator::kTableLevels][Oscillator::kTableSize + 1];
+bool Oscillator::sawTableReady = false;
+
+// Highest harmonic stored in a mip level
+static constexpr int tableHarmonics(int level) { return (Oscillator::kTableSize / 4 - 1) >> level; }
+
+void Oscillator::buildSawTable() {
+  // Harmonic h of the ramp 2x - 1 is -(2 / pi) sin(2 pi h x) / h. The levels are
+  // summed from the top (fewest harmonics) down, each one adding the harmonics
+  // the next higher level lacks, so every harmonic is only summed once.
+  std::vector<float> sine(kTableSize), sum(kTableSize, 0.0f);
+  for (int i = 0; i < kTableSize; i++) sine[i] = std::sin(2.0f * (float)M_PI * i / kTableSize);
+
+  int h = 1;
+  for (int level = kTableLevels - 1; level >= 0; level--) {
+    for (; h <= tableHarmonics(level); h++) {
+      const float amp = -2.0f / ((float)M_PI * h);
+      for (int i = 0; i < kTableSize; i++) sum[i] += amp * sine[(h * i) & (kTableSize - 1)];
+    }
+    for (int i = 0; i < kTableSize; i++) sawTable[level][i] = (int16_t)std::lrint(sum[i] * kTableOne);
+    sawTable[level][kTableSize] = sawTable[level][0];
+  }
+  sawTableReady = true;
+}
+#endif
+
+Oscillator::Oscillator() {
+#if OSCILLATOR_WAVETABLE_SUPPORT
+  if (method == WAVETABLE && !sawTableReady) buildSawTable();
+#endif
+  updateIncrement();
+}
+
+void Oscillator::setSampleRate(float rate) {
+  sampleRate = rate;
+  invSampleRate = 1.0f / rate;
+  updateIncrement();
+}
 
 void Oscillator::setFrequency(float f) {
   frequency = f;
-  phaseIncrement = frequency / sampleRate;
-  subPhaseIncrement = (frequency * 0.5f) / sampleRate;
-  phase = 0.0f;
-  subPhase = 0.0f;
+  targetFreq = f;
+  glideSteps = 0;
+  updateIncrement();
+  phase = 0;
+  subPhase = 0;
+}
+
+void Oscillator::setMethod(Method m) {
+#if OSCILLATOR_WAVETABLE_SUPPORT
+  if (m == WAVETABLE && !sawTableReady) buildSawTable();
+  method = m;
+#else
+  (void)m;
+#endif
 }
 
 void Oscillator::setWaveform(Waveform w) {
@@ -21,37 +83,75 @@ void Oscillator::setWaveform(Waveform w) {
 
 void Oscillator::setBlend(float b) {
   blend = std::max(0.0f, std::min(1.0f, b));
+  selectKernel();
 }
 
 void Oscillator::setMode(bool jc303) {
   jc303Mode = jc303;
   // 0.53 is an approximation of the 303 square pulse width
   // derived from tanh(70*x + 4.37) shaping of a saw wave
-  pulseWidth = jc303Mode ? 0.53f : 0.5f; 
+  pulseWidth = jc303Mode ? 0.53f : 0.5f;
+  pulseOffset = (uint32_t)(pulseWidth * kPhaseScale);
 }
 
 void Oscillator::glideTo(float newFreq, float glideTimeMs) {
   targetFreq = newFreq;
-  glideSamples = (glideTimeMs / 1000.0f) * sampleRate;
-  if (glideSamples < 1) glideSamples = 1;
-  glideStep = std::pow(targetFreq / frequency, 1.0f / glideSamples);  // exponential step
-  glideCounter = (int)glideSamples;
-}
-
-void Oscillator::tick() {
-  if (glideCounter > 0) {
-    frequency *= glideStep;
-    phaseIncrement = frequency / sampleRate;
-    subPhaseIncrement = (frequency * 0.5f) / sampleRate;
-    glideCounter--;
+  float glideSamples = (glideTimeMs / 1000.0f) * sampleRate;
+
+  // Shorter than one control step: jump straight to the new pitch
+  if (glideSamples <= kGlideInterval) {
+    frequency = targetFreq;
+    glideSteps = 0;
+    updateIncrement();
+    return;
+  }
+
+  glideSteps = (int)std::ceil(glideSamples / kGlideInterval);
+  // Exponential step: equal log2 increments, (target / f)^(1 / steps) without pow()
+  glideStep = curves::exp2Fast(curves::log2Fast(targetFreq / frequency) / glideSteps);
+  glideClock = kGlideInterval;
+}
+
+void SYNTH_RAM_FUNC(Oscillator::tick)() {
+  if (glideSteps > 0) {
+    // Land exactly on the target on the last step (no accumulated drift)
+    frequency = (--glideSteps > 0) ? frequency * glideStep : targetFreq;
+    updateIncrement();
   }
 }
 
 void Oscillator::setSubBlend(float b) {
   subBlend = std::max(0.0f, std::min(1.0f, b));
+  selectKernel();
+}
+
+void Oscillator::selectKernel() {
+  if (blend <= 0.0f) kernel = KERNEL_SQUARE;
+  else if (blend >= 1.0f) kernel = KERNEL_SAW;
+  else kernel = KERNEL_BLEND;
+  subActive = subBlend > 0.0f;
+}
+
+void SYNTH_RAM_FUNC(Oscillator::updateIncrement)() {
+  float cycles = frequency * invSampleRate;
+  phaseIncrement = cycles;
+  phaseInc = (uint32_t)(cycles * kPhaseScale);
+  subPhaseInc = phaseInc >> 1;
+  invPhaseInc = phaseInc ? 1.0f / (float)phaseInc : 0.0f;
+  incShift = phaseInc ? __builtin_clz(phaseInc) : 0;
+  incRecip = phaseInc ? (uint32_t)std::min(9.223372037e18f / (float)(phaseInc << incShift),
+                                           4294967040.0f) : 0;  // 2^63 / x, below 2^32
+
+#if OSCILLATOR_WAVETABLE_SUPPORT
+  // Richest mip level whose top harmonic stays below Nyquist (h * inc < 2^31)
+  tableLevel = 0;
+  while (tableLevel < kTableLevels - 1 && (uint64_t)tableHarmonics(tableLevel) * phaseInc >= 0x80000000u) {
+    tableLevel++;
+  }
+#endif
 }
 
-float Oscillator::polyBLEP(float t) {
+float SYNTH_RAM_FUNC(Oscillator::polyBLEP)(float t) {
   if (t < phaseIncrement) {
     t /= phaseIncrement;
     return t + t - t * t - 1.0f;
@@ -62,30 +162,264 @@ float Oscillator::polyBLEP(float t) {
   return 0.0f;
 }
 
-float Oscillator::process() {
-  tick();
+// PolyBLEP residual for a step at phase 0, evaluated on the fixed-point phase.
+// p / inc is the distance to the edge in samples.
+static inline float polyBLEPFixed(uint32_t p, uint32_t inc, float invInc) {
+  if (p < inc) {
+    float t = (float)p * invInc;
+    return t + t - t * t - 1.0f;
+  } else if (p > ~inc) {
+    float t = -(float)(0u - p) * invInc;
+    return t * t + t + t + 1.0f;
+  }
+  return 0.0f;
+}
+
+// Q15 PolyBLEP residual: p / inc is formed as (p << shift) * recip >> 32 (Q31)
+static inline int32_t polyBLEPQ15(uint32_t p, uint32_t inc, int shift, uint32_t recip) {
+  if (p < inc) {
+    int32_t t = (int32_t)(((uint64_t)(p << shift) * recip) >> 48);
+    return t + t - ((t * t) >> 15) - 32768;
+  } else if (p > ~inc) {
+    int32_t t = -(int32_t)(((uint64_t)((0u - p) << shift) * recip) >> 48);
+    return ((t * t) >> 15) + t + t + 32768;
+  }
+  return 0;
+}
+template <Oscillator::Kernel K, bool Sub>
+void SYNTH_RAM_FUNC(Oscillator::render)(float* out, int n) {
+  uint32_t ph = phase;
+  uint32_t subPh = subPhase;
+  const uint32_t inc = phaseInc;
+  const uint32_t subInc = subPhaseInc;
+  const uint32_t pwOffset = pulseOffset;
+  const float invInc = invPhaseInc;
+
+  // Fold blend, sub blend and the 0.707 output trim into fixed gains
+  const float mainGain = (Sub ? (1.0f - subBlend) : 1.0f) * 0.707f;
+  const float squareGain = (K == KERNEL_BLEND ? (1.0f - blend) : 1.0f) * mainGain;
+  const float sawGain = (K == KERNEL_BLEND ? blend : 1.0f) * mainGain;
+  const float subGain = subBlend * 0.707f;
+
+  for (int i = 0; i < n; i++) {
+    float value = 0.0f;
+
+    if (K != KERNEL_SQUARE) {
+      // Saw with its reset edge shifted by half a cycle
+      uint32_t shifted = ph + 0x80000000u;
+      float saw = 2.0f * ((float)shifted * kInvPhaseScale) - 1.0f - polyBLEPFixed(shifted, inc, invInc);
+      value += sawGain * saw;
+    }
+
+    if (K != KERNEL_SAW) {
+      // Variable Pulse Width Square: rising edge at 0, falling edge at pulseWidth
+      float square = (ph < pwOffset ? 1.0f : -1.0f);
+      square += polyBLEPFixed(ph, inc, invInc);
+      square -= polyBLEPFixed(ph - pwOffset, inc, invInc);
+      value += squareGain * square;
+    }
+
+    if (Sub) {
+      value += subGain * ((subPh < 0x80000000u) ? 1.0f : -1.0f);
+      subPh += subInc;
+    }
+
+    out[i] = value;
+    ph += inc;
+  }
+
+  phase = ph;
+  subPhase = subPh;
+}
+
+template <Oscillator::Kernel K, bool Sub>
+void SYNTH_RAM_FUNC(Oscillator::render)(int32_t* out, int n) {
+  uint32_t ph = phase;
+  uint32_t subPh = subPhase;
+  const uint32_t inc = phaseInc;
+  const uint32_t subInc = subPhaseInc;
+  const uint32_t pwOffset = pulseOffset;
+  const int shift = incShift;
+  const uint32_t recip = incRecip;
+
+  // Same gains as the float kernel, in Q15; waveforms are Q15, sums Q30
+  const float mainGain = (Sub ? (1.0f - subBlend) : 1.0f) * 0.707f;
+  const int32_t squareGain = (int32_t)((K == KERNEL_BLEND ? (1.0f - blend) : 1.0f) * mainGain * 32768.0f);
+  const int32_t sawGain = (int32_t)((K == KERNEL_BLEND ? blend : 1.0f) * mainGain * 32768.0f);
+  const int32_t subGain = (int32_t)(subBlend * 0.707f * 32768.0f);
+
+  for (int i = 0; i < n; i++) {
+    int32_t value = 0;
+
+    if (K != KERNEL_SQUARE) {
+      uint32_t shifted = ph + 0x80000000u;
+      int32_t saw = ((int32_t)(shifted - 0x80000000u) >> 16) - polyBLEPQ15(shifted, inc, shift, recip);
+      value += sawGain * saw;
+    }
+
+    if (K != KERNEL_SAW) {
+      int32_t square = ph < pwOffset ? 32767 : -32768;
+      square += polyBLEPQ15(ph, inc, shift, recip);
+      square -= polyBLEPQ15(ph - pwOffset, inc, shift, recip);
+      value += squareGain * square;
+    }
+
+    if (Sub) {
+      value += subPh < 0x80000000u ? subGain * 32767 : -subGain * 32768;
+      subPh += subInc;
+    }
+
+    out[i] = value >> (30 - fixp::kSignalBits);
+    ph += inc;
+  }
+
+  phase = ph;
+  subPhase = subPh;
+}
+
+#if OSCILLATOR_WAVETABLE_SUPPORT
+// Linearly interpolated table read in Q14 (15-bit fraction, so the product fits 32 bits).
+// Both kernel sets use it; the float kernel converts once per waveform.
+static inline int32_t tableRead(const int16_t* t, uint32_t p) {
+  const uint32_t i = p >> kFracBits;
+  const int32_t f = (int32_t)((p >> (kFracBits - 15)) & 0x7FFF);
+  const int32_t a = t[i];
+  return a + (((t[i + 1] - a) * f) >> 15);
+}
+
+template <Oscillator::Kernel K, bool Sub>
+void SYNTH_RAM_FUNC(Oscillator::renderTable)(float* out, int n) {
+  uint32_t ph = phase;
+  uint32_t subPh = subPhase;
+  const uint32_t inc = phaseInc;
+  const uint32_t subInc = subPhaseInc;
+  const uint32_t pwOffset = pulseOffset;
+  const int16_t* table = sawTable[tableLevel];
+
+  // Same gains as render(), plus the Q14 table scale
+  const float mainGain = (Sub ? (1.0f - subBlend) : 1.0f) * 0.707f;
+  const float squareGain = (K == KERNEL_BLEND ? (1.0f - blend) : 1.0f) * mainGain * (1.0f / kTableOne);
+  const float sawGain = (K == KERNEL_BLEND ? blend : 1.0f) * mainGain * (1.0f / kTableOne);
+  const float subGain = subBlend * 0.707f;
+  // ramp(x - w) - ramp(x) is the pulse minus its mean 2w - 1
+  const int32_t pulseDc = (int32_t)(((int64_t)pwOffset - 0x80000000LL) >> 17);
+
+  for (int i = 0; i < n; i++) {
+    float value = 0.0f;
+
+    if (K != KERNEL_SQUARE) {
+      // Saw with its reset edge shifted by half a cycle
+      value += sawGain * (float)tableRead(table, ph + 0x80000000u);
+    }
+
+    if (K != KERNEL_SAW) {
+      // Rising edge at 0, falling edge at pulseWidth
+      int32_t square = tableRead(table, ph - pwOffset) - tableRead(table, ph) + pulseDc;
+      value += squareGain * (float)square;
+    }
+
+    if (Sub) {
+      value += subGain * ((subPh < 0x80000000u) ? 1.0f : -1.0f);
+      subPh += subInc;
+    }
+
+    out[i] = value;
+    ph += inc;
+  }
+
+  phase = ph;
+  subPhase = subPh;
+}
+
+template <Oscillator::Kernel K, bool Sub>
+void SYNTH_RAM_FUNC(Oscillator::renderTable)(int32_t* out, int n) {
+  uint32_t ph = phase;
+  uint32_t subPh = subPhase;
+  const uint32_t inc = phaseInc;
+  const uint32_t subInc = subPhaseInc;
+  const uint32_t pwOffset = pulseOffset;
+  const int16_t* table = sawTable[tableLevel];
 
-  float shifted = fmod(phase + 0.5f, 1.0f);
-  float saw = 2.0f * shifted - 1.0f - polyBLEP(shifted);
-  
-  // Variable Pulse Width Square (PolyBLEP)
-  float square = (phase < pulseWidth ? 1.0f : -1.0f);
-  square += polyBLEP(phase); // Rising edge at 0
-  square -= polyBLEP(fmod(phase + 1.0f - pulseWidth, 1.0f)); // Falling edge at pulseWidth
+  // Q15 gains on Q14 waveforms, sums Q29
+  const float mainGain = (Sub ? (1.0f - subBlend) : 1.0f) * 0.707f;
+  const int32_t squareGain = (int32_t)((K == KERNEL_BLEND ? (1.0f - blend) : 1.0f) * mainGain * 32768.0f);
+  const int32_t sawGain = (int32_t)((K == KERNEL_BLEND ? blend : 1.0f) * mainGain * 32768.0f);
+  const int32_t subGain = (int32_t)(subBlend * 0.707f * 32768.0f);
+  const int32_t pulseDc = (int32_t)(((int64_t)pwOffset - 0x80000000LL) >> 17);
 
-  float value = (1.0f - blend) * square + blend * saw;
+  for (int i = 0; i < n; i++) {
+    int32_t value = 0;
 
-  // Sub oscillator
-  float subVal = (subPhase < 0.5f) ? 1.0f : -1.0f;
-  subPhase += subPhaseIncrement;
-  if (subPhase >= 1.0f) subPhase -= floorf(subPhase);
+    if (K != KERNEL_SQUARE) {
+      value += sawGain * tableRead(table, ph + 0x80000000u);
+    }
 
-  // ✅ Blend with sub
-  value = (1.0f - subBlend) * value + subBlend * subVal;
-  value *= 0.707f;
+    if (K != KERNEL_SAW) {
+      int32_t square = tableRead(table, ph - pwOffset) - tableRead(table, ph) + pulseDc;
+      value += squareGain * square;
+    }
+
+    if (Sub) {
+      value += subPh < 0x80000000u ? subGain * 16384 : -subGain * 16384;
+      subPh += subInc;
+    }
+
+    out[i] = value >> (29 - fixp::kSignalBits);
+    ph += inc;
+  }
+
+  phase = ph;
+  subPhase = subPh;
+}
+#endif
 
-  phase += phaseIncrement;
-  if (phase >= 1.0f) phase -= floorf(phase);  // clean wrap
+template <Oscillator::Kernel K, bool Sub, typename T>
+void SYNTH_RAM_FUNC(Oscillator::renderRun)(T* out, int n) {
+#if OSCILLATOR_WAVETABLE_SUPPORT
+  if (method == WAVETABLE) {
+    renderTable<K, Sub>(out, n);
+    return;
+  }
+#endif
+  render<K, Sub>(out, n);
+}
 
+float SYNTH_RAM_FUNC(Oscillator::process)() {
+  float value;
+  process(&value, 1);
   return value;
-}
\ No newline at end of file
+}
+
+void SYNTH_RAM_FUNC(Oscillator::process)(float* out, int n) {
+  processBlock(out, n);
+}
+
+void SYNTH_RAM_FUNC(Oscillator::process)(int32_t* out, int n) {
+  processBlock(out, n);
+}
+
+template <typename T>
+void SYNTH_RAM_FUNC(Oscillator::processBlock)(T* out, int n) {
+  int i = 0;
+  while (i < n) {
+    // Render up to the next glide step with a constant increment
+    int run = std::min(n - i, glideClock);
+    switch (kernel) {
+      case KERNEL_SQUARE:
+        subActive ? renderRun<KERNEL_SQUARE, true>(out + i, run) : renderRun<KERNEL_SQUARE, false>(out + i, run);
+        break;
+      case KERNEL_SAW:
+        subActive ? renderRun<KERNEL_SAW, true>(out + i, run) : renderRun<KERNEL_SAW, false>(out + i, run);
+        break;
+      case KERNEL_BLEND:
+        subActive ? renderRun<KERNEL_BLEND, true>(out + i, run) : renderRun<KERNEL_BLEND, false>(out + i, run);
+        break;
+    }
+    i += run;
+    glideClock -= run;
+    if (glideClock <= 0) {
+      glideClock = kGlideInterval;
+      tick();
+    }
+  }
+}
@@ -1,4 +1,16 @@
 #pragma once
+#include <stdint.h>
+
+// Default band-limiting method: 0 = PolyBLEP (reference), 1 = mip-mapped
+// wavetable (Oscillator::WAVETABLE, switchable at runtime with setMethod())
+#ifndef OSCILLATOR_WAVETABLE
+#define OSCILLATOR_WAVETABLE 0
+#endif
+// 1 = build the WAVETABLE method in (37 KB table in RAM, built at startup);
+// without it setMethod(WAVETABLE) keeps PolyBLEP and the table costs nothing
+#ifndef OSCILLATOR_WAVETABLE_SUPPORT
+#define OSCILLATOR_WAVETABLE_SUPPORT OSCILLATOR_WAVETABLE
+#endif
 
 /**
  * @file Oscillator.h
@@ -9,19 +21,29 @@
  * @class Oscillator
  * @brief Generates band-limited waveforms using PolyBLEP technique.
  * Supports Sawtooth, Square (with variable pulse width), and Sub-oscillator.
+ * Phase is a 32-bit fixed-point accumulator (1.0 = 2^32), so wrapping is free.
+ *
+ * The WAVETABLE method reads a mip-mapped band-limited saw instead (one table
+ * per octave, built once at startup and shared by all oscillators). The pulse
+ * is the difference of two saw lookups pulseWidth apart, so the 53% JC303 width
+ * and the saw/square blend need no tables of their own.
  */
 class Oscillator {
 public:
   enum Waveform { SAW,
                   SQUARE };
 
+  /// Band-limiting method
+  enum Method { POLYBLEP,    ///< PolyBLEP-corrected naive waveforms (reference)
+                WAVETABLE }; ///< Interpolated mip-mapped saw table
+
+  Oscillator();
+
   /**
    * @brief Sets the sample rate for the oscillator.
    * @param rate Sample rate in Hz
    */
-  void setSampleRate(float rate) {
-    sampleRate = rate;
-  }
+  void setSampleRate(float rate);
 
   /**
    * @brief Sets the oscillator frequency.
@@ -55,7 +77,8 @@ public:
   void glideTo(float newFreq, float glideTimeMs);
 
   /**
-   * @brief Advances the oscillator state. Should be called once per sample.
+   * @brief Advances the glide by one control step.
+   * Called by process() once every kGlideInterval samples.
    */
   void tick();
 
@@ -65,17 +88,40 @@ public:
    */
   float process();
 
+  /**
+   * @brief Generates a block of audio samples.
+   * @param out Output buffer (n values in range [-1.0, 1.0])
+   * @param n Number of samples
+   */
+  void process(float* out, int n);
+
+  /**
+   * @brief Generates a block in Q5.26 (see FixedPoint.h), for cores without an FPU.
+   * Same waveforms as the float path; the PolyBLEP runs in Q15.
+   * @param out Output buffer (n values)
+   * @param n Number of samples
+   */
+  void process(int32_t* out, int n);
+
   /**
    * @brief Sets the oscillator mode (Standard vs JC303).
    * @param jc303 If true, enables JC303 mode with 53% pulse width.
    */
   void setMode(bool jc303);
 
+  /**
+   * @brief Selects the band-limiting method (builds the shared tables on first use).
+   * WAVETABLE is ignored unless OSCILLATOR_WAVETABLE_SUPPORT is set.
+   * @param m POLYBLEP or WAVETABLE
+   */
+  void setMethod(Method m);
+  Method getMethod() const { return method; }
+
   /**
    * @brief Resets the oscillator phase to 0.
    */
-  void resetPhase() { phase = 0.0f; subPhase = 0.0f; }
-  
+  void resetPhase() { phase = 0; subPhase = 0; }
+
   /**
    * @brief PolyBLEP (Polynomial Band-Limited Step) function.
    * Used to reduce aliasing on sharp transitions.
@@ -84,21 +130,79 @@ public:
    */
   float polyBLEP(float t);
 
+  /// Samples between glide steps (pitch is updated at this control rate)
+  static constexpr int kGlideInterval = 16;
+
+  /// Wavetable size (log2) and mip levels: level k holds harmonics up to
+  /// (kTableSize / 4 - 1) >> k (511 at level 0), half the table's Nyquist, so
+  /// the top harmonic has 4+ samples per cycle for the linear interpolation
+  static constexpr int kTableBits = 11;
+  static constexpr int kTableSize = 1 << kTableBits;
+  static constexpr int kTableLevels = 9;
+
 private:
+  // Waveform kernel, picked in setBlend/setSubBlend
+  enum Kernel { KERNEL_SQUARE, KERNEL_SAW, KERNEL_BLEND };
+
+  template <Kernel K, bool Sub>
+  void render(float* out, int n);
+  template <Kernel K, bool Sub>
+  void render(int32_t* out, int n);
+#if OSCILLATOR_WAVETABLE_SUPPORT
+  template <Kernel K, bool Sub>
+  void renderTable(float* out, int n);
+  template <Kernel K, bool Sub>
+  void renderTable(int32_t* out, int n);
+#endif
+  template <Kernel K, bool Sub, typename T>
+  void renderRun(T* out, int n);
+  template <typename T>
+  void processBlock(T* out, int n);
+  void selectKernel();
+  void updateIncrement();
+
   float sampleRate = 44100.0f;
+  float invSampleRate = 1.0f / 44100.0f;
   float frequency = 440.0f;
-  float phase = 0.0f;
-  float phaseIncrement = 0.01f;
   float blend = 0.0f;
-  float targetFreq = 440.0f;
-  float glideSamples = 0;
-  float glideStep = 0;
-  int glideCounter = 0;
   float subBlend = 0.0f;
-  float subPhase = 0.0f;
-  float subPhaseIncrement = 0.005f;
   Waveform waveform = SAW;
-  
+
+  // Fixed-point phase state
+  uint32_t phase = 0;
+  uint32_t phaseInc = 0;
+  uint32_t subPhase = 0;
+  uint32_t subPhaseInc = 0;
+  uint32_t pulseOffset = 0x80000000u; // pulseWidth as phase (falling edge position)
+  float phaseIncrement = 0.01f; // phaseInc in cycles per sample (PolyBLEP width)
+  float invPhaseInc = 0.0f;     // 1 / phaseInc in phase units
+  // Fixed-point 1 / phaseInc: phaseInc << incShift is normalized to [2^31, 2^32)
+  // and incRecip = 2^63 / (phaseInc << incShift)
+  uint32_t incRecip = 0;
+  int incShift = 0;
+
+  // Control-rate glide
+  float targetFreq = 440.0f;
+  float glideStep = 1.0f;   // Frequency ratio per glide step
+  int glideSteps = 0;       // Remaining glide steps
+  int glideClock = kGlideInterval; // Samples until the next glide step
+
+  Kernel kernel = KERNEL_SQUARE;
+  bool subActive = false;
+
+#if OSCILLATOR_WAVETABLE_SUPPORT
+  Method method = OSCILLATOR_WAVETABLE ? WAVETABLE : POLYBLEP;
+  int tableLevel = 0;  // Mip level for phaseInc
+
+  // Band-limited ramp 2x - 1 per mip level, Q14 (the Gibbs overshoot needs headroom),
+  // with a guard entry so the interpolation never wraps
+  static int16_t sawTable[kTableLevels][kTableSize + 1];
+  static bool sawTableReady;
+  static void buildSawTable();
+#else
+  Method method = POLYBLEP;
+#endif
+
   bool jc303Mode = true;
   float pulseWidth = 0.5f; // 0.5 = square, 0.53 = 303-ish
-};
\ No newline at end of file
+};
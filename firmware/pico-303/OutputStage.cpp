@@ -0,0 +1,73 @@
+/**
+ * @file OutputStage.cpp
+ * @brief Implementation of the OutputStage class.
+ */
+
+#include "OutputStage.h"
+#include "HotPath.h"
+#include "ControlCurves.h"
+#include "FixedPoint.h"
+
+namespace {
+
+// tanh over [0, 8] in Q15 (1.0 = 32768, so unsigned), 64 steps per unit
+constexpr int kTanhStepsPerUnit = 64;
+constexpr int kTanhSize = 8 * kTanhStepsPerUnit + 1;
+
+constexpr std::array<uint16_t, kTanhSize> makeTanhTable() {
+  std::array<uint16_t, kTanhSize> t{};
+  for (int i = 0; i < kTanhSize; i++) {
+    double e = curves::cexp(2.0 * i / kTanhStepsPerUnit);
+    t[i] = (uint16_t)((1.0 - 2.0 / (e + 1.0)) * 32768.0 + 0.5);
+  }
+  return t;
+}
+
+SYNTH_RAM_DATA("tanhQ15") constexpr std::array<uint16_t, kTanhSize> kTanhQ15 = makeTanhTable();
+
+// y (Q15) times an int16 scale, rounded half away from zero like
+// saturateToInt16(), then saturated
+inline int32_t scaleQ15(int32_t y, int32_t scale) {
+  const int32_t m = ((y < 0 ? -y : y) * scale + 16384) >> 15;
+  return fixp::sat<16>(y < 0 ? -m : m);
+}
+
+}  // namespace
+
+int32_t SYNTH_RAM_FUNC(OutputStage::tanhQ15)(int32_t x) {
+  uint32_t a = x < 0 ? 0u - (uint32_t)x : (uint32_t)x;
+  int32_t y;
+  if (a >= (8u << fixp::kSignalBits)) {
+    y = kTanhQ15[kTanhSize - 1];
+  } else {
+    constexpr int kIndexShift = fixp::kSignalBits - 6;  // 1/64 steps
+    uint32_t idx = a >> kIndexShift;
+    int32_t frac = (a >> (kIndexShift - 16)) & 0xFFFF;
+    int32_t lo = kTanhQ15[idx];
+    y = lo + (((kTanhQ15[idx + 1] - lo) * frac + 0x8000) >> 16);
+  }
+  return x < 0 ? -y : y;
+}
+
+void SYNTH_RAM_FUNC(OutputStage::process)(const float* left, const float* right, int16_t* out, int n) const {
+  // Write each L/R frame as one 32-bit store (L in the low half, little-endian)
+  uint32_t* frames = reinterpret_cast<uint32_t*>(out);
+  const float inG = inputGain;
+  const float outG = outputScale;
+  for (int i = 0; i < n; i++) {
+    int32_t l = saturateToInt16(fastTanh(left[i] * inG) * outG);
+    int32_t r = saturateToInt16(fastTanh(right[i] * inG) * outG);
+    frames[i] = (uint32_t)(uint16_t)l | ((uint32_t)(uint16_t)r << 16);
+  }
+}
+
+void SYNTH_RAM_FUNC(OutputStage::process)(const int32_t* left, const int32_t* right, int16_t* out, int n) const {
+  uint32_t* frames = reinterpret_cast<uint32_t*>(out);
+  const int32_t inG = fixp::toSignal(inputGain);
+  const int32_t outG = (int32_t)outputScale;
+  for (int i = 0; i < n; i++) {
+    int32_t l = scaleQ15(tanhQ15(fixp::mul<fixp::kSignalBits>(left[i], inG)), outG);
+    int32_t r = scaleQ15(tanhQ15(fixp::mul<fixp::kSignalBits>(right[i], inG)), outG);
+    frames[i] = (uint32_t)(uint16_t)l | ((uint32_t)(uint16_t)r << 16);
+  }
+}
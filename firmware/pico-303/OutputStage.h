@@ -0,0 +1,101 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file OutputStage.h
+ * @brief Final soft clipper and float to int16 conversion.
+ */
+
+/**
+ * @class OutputStage
+ * @brief Soft-clips the stereo output with a fast tanh approximation and
+ * converts it to interleaved, saturated int16 frames for I2S.
+ */
+class OutputStage {
+public:
+  /**
+   * @brief Sets the gain applied before the soft clipper.
+   * @param g Input gain (default 0.10)
+   */
+  void setInputGain(float g) { inputGain = g; }
+
+  /**
+   * @brief Sets the output scale after the soft clipper.
+   * @param s Output scale in int16 units (default 30000, leaves ~1dB headroom)
+   */
+  void setOutputScale(float s) { outputScale = s; }
+
+  /**
+   * @brief Soft-clips a stereo block and writes interleaved int16 frames.
+   * @param left Left channel input (n values)
+   * @param right Right channel input (n values)
+   * @param out Interleaved L/R output, must be 4-byte aligned (2 * n values)
+   * @param n Number of frames
+   */
+  void process(const float* left, const float* right, int16_t* out, int n) const;
+
+  /**
+   * @brief Fixed-point version of process() for Q5.26 input (see FixedPoint.h).
+   * tanh comes from tanhQ15(); the output is within 2.2 LSB of std::tanh at the
+   * default scale: tanhQ15()'s 1.78 Q15 LSB times 30000/32768, 0.5 LSB final
+   * rounding and under 0.04 LSB from the truncated Q5.26 input gain
+   * (pico303-render --tanh-test).
+   * @param left Left channel input (n values)
+   * @param right Right channel input (n values)
+   * @param out Interleaved L/R output, must be 4-byte aligned (2 * n values)
+   * @param n Number of frames
+   */
+  void process(const int32_t* left, const int32_t* right, int16_t* out, int n) const;
+
+  /**
+   * @brief Fast tanh approximation (7/6 Lambert continued fraction).
+   * Max absolute error vs std::tanh is below 1e-4 for all inputs, largest at
+   * the clamp (about 3 LSB at the default output scale).
+   * @param x Input value
+   * @return float Value in [-1.0, 1.0]
+   */
+  static inline float fastTanh(float x) {
+    // The fraction reaches 1.0 at |x| ~ 4.98, clamp just before it
+    if (x > 4.97f) x = 4.97f;
+    else if (x < -4.97f) x = -4.97f;
+    float x2 = x * x;
+    float num = x * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2)));
+    float den = 135135.0f + x2 * (62370.0f + x2 * (3150.0f + 28.0f * x2));
+    return num / den;
+  }
+
+  /**
+   * @brief tanh of a Q5.26 value from a 1/64-step Q15 table with linear
+   * interpolation. Max error vs std::tanh is below 1.78 Q15 LSB: 0.5 LSB for the
+   * rounded entries, 0.5 LSB for the rounded interpolation, the 1/64-step chord
+   * error h^2/8 * max|tanh''| = 0.77 LSB and under 0.01 LSB from the 16-bit
+   * fraction.
+   * @param x Input in Q5.26
+   * @return int32_t Q15 value in [-32768, 32768]
+   */
+  static int32_t tanhQ15(int32_t x);
+
+  /**
+   * @brief Rounds and saturates a float to int16 (SSAT on Cortex-M33).
+   * @param x Value in int16 units
+   * @return int32_t Value clamped to [-32768, 32767]
+   */
+  static inline int32_t saturateToInt16(float x);
+
+private:
+  float inputGain = 0.10f;
+  float outputScale = 30000.0f;
+};
+
+#if defined(__ARM_FEATURE_SAT)
+#include <arm_acle.h>
+#endif
+
+inline int32_t OutputStage::saturateToInt16(float x) {
+  int32_t v = (int32_t)(x + (x >= 0.0f ? 0.5f : -0.5f));
+#if defined(__ARM_FEATURE_SAT)
+  return __ssat(v, 16);
+#else
+  return v > 32767 ? 32767 : (v < -32768 ? -32768 : v);
+#endif
+}
@@ -0,0 +1,49 @@
+/**
+ * @file Oversampler.cpp
+ * @brief Implementation of the Oversampler class.
+ */
+
+#include "Oversampler.h"
+#include "HotPath.h"
+
+// Kaiser-windowed (beta 6) half-band designs, odd taps from the centre outwards.
+// The centre tap is 0.5 and all other even taps are zero.
+SYNTH_RAM_DATA("oversampler") const float Oversampler::kStage1Coeffs[kStage1Taps] = {
+  3.159080564e-01f, -9.906754661e-02f, 5.251021878e-02f, -3.098579821e-02f, 1.848722506e-02f,
+  -1.064893747e-02f, 5.707841252e-03f, -2.717863933e-03f, 1.052865509e-03f, -2.491783832e-04f
+};
+
+SYNTH_RAM_DATA("oversampler") const float Oversampler::kStage2Coeffs[kStage2Taps] = {
+  3.007941050e-01f, -6.270991422e-02f, 1.271238043e-02f, -6.760067248e-04f
+};
+
+Oversampler::Oversampler()
+  : up1(kStage1Coeffs), up2(kStage2Coeffs), down2(kStage2Coeffs), down1(kStage1Coeffs) {
+}
+
+void Oversampler::setFactor(int f) {
+  int newFactor = (f == 2 || f == 4) ? f : 1;
+  if (newFactor != factor) {
+    factor = newFactor;
+    reset();
+  }
+}
+
+void Oversampler::reset() {
+  up1.reset();
+  up2.reset();
+  down2.reset();
+  down1.reset();
+}
+
+float* SYNTH_RAM_FUNC(Oversampler::up)(const float* in, int n) {
+  up1.process(in, buf2x, n);
+  if (factor == 2) return buf2x;
+  up2.process(buf2x, buf4x, n * 2);
+  return buf4x;
+}
+
+void SYNTH_RAM_FUNC(Oversampler::down)(float* out, int n) {
+  if (factor == 4) down2.process(buf4x, buf2x, n * 2);
+  down1.process(buf2x, out, n);
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+/**
+ * @file Oversampler.h
+ * @brief 2x / 4x block oversampling built from polyphase half-band FIR stages.
+ */
+
+/**
+ * @class HalfbandUpsampler
+ * @brief Doubles the sample rate with a linear-phase half-band FIR.
+ * Only the K distinct odd taps run (symmetric pairs are pre-added); the other
+ * polyphase branch is the centre tap, i.e. a plain delay.
+ * @tparam K Number of distinct odd taps (filter length 4K - 1)
+ * @tparam MaxIn Largest input block
+ */
+template <int K, int MaxIn>
+class HalfbandUpsampler {
+public:
+  explicit HalfbandUpsampler(const float* coeffs) : c(coeffs) { reset(); }
+
+  void reset() {
+    for (float& v : buf) v = 0.0f;
+  }
+
+  /**
+   * @brief Upsamples a block.
+   * @param in Input (n values, n <= MaxIn)
+   * @param out Output (2n values)
+   * @param n Number of input samples
+   */
+  void process(const float* in, float* out, int n) {
+    for (int i = 0; i < n; i++) buf[kHistory + i] = in[i];
+    for (int i = 0; i < n; i++) {
+      const float* w = buf + i;  // w[2K - 1] is the newest input
+      float acc = 0.0f;
+      for (int k = 0; k < K; k++) acc += c[k] * (w[K - 1 - k] + w[K + k]);
+      out[2 * i] = 2.0f * acc;
+      out[2 * i + 1] = w[K];  // Centre tap (0.5) times the interpolation gain of 2
+    }
+    for (int i = 0; i < kHistory; i++) buf[i] = buf[n + i];
+  }
+
+private:
+  static constexpr int kHistory = 2 * K - 1;
+  const float* c;
+  float buf[kHistory + MaxIn];
+};
+
+/**
+ * @class HalfbandDownsampler
+ * @brief Halves the sample rate with a linear-phase half-band FIR.
+ * The even input phase runs the K symmetric odd taps, the odd phase only the centre tap.
+ * @tparam K Number of distinct odd taps (filter length 4K - 1)
+ * @tparam MaxOut Largest output block
+ */
+template <int K, int MaxOut>
+class HalfbandDownsampler {
+public:
+  explicit HalfbandDownsampler(const float* coeffs) : c(coeffs) { reset(); }
+
+  void reset() {
+    for (float& v : even) v = 0.0f;
+    for (float& v : odd) v = 0.0f;
+  }
+
+  /**
+   * @brief Downsamples a block.
+   * @param in Input (2n values)
+   * @param out Output (n values, n <= MaxOut)
+   * @param n Number of output samples
+   */
+  void process(const float* in, float* out, int n) {
+    for (int i = 0; i < n; i++) {
+      even[kEvenHistory + i] = in[2 * i];
+      odd[K + i] = in[2 * i + 1];
+    }
+    for (int i = 0; i < n; i++) {
+      const float* w = even + i;
+      float acc = 0.0f;
+      for (int k = 0; k < K; k++) acc += c[k] * (w[K - 1 - k] + w[K + k]);
+      out[i] = acc + 0.5f * odd[i];
+    }
+    for (int i = 0; i < kEvenHistory; i++) even[i] = even[n + i];
+    for (int i = 0; i < K; i++) odd[i] = odd[n + i];
+  }
+
+private:
+  static constexpr int kEvenHistory = 2 * K - 1;
+  const float* c;
+  float even[kEvenHistory + MaxOut];
+  float odd[K + MaxOut];
+};
+
+/**
+ * @class Oversampler
+ * @brief Runs a block at 1x, 2x or 4x the base rate.
+ * 2x uses a 39-tap half-band (passband to 0.2 fs, -60 dB from 0.3 fs); the
+ * 4x stage adds a 15-tap half-band between 2x and 4x, where the transition
+ * band is much wider.
+ */
+class Oversampler {
+public:
+  /// Largest base-rate block per call
+  static constexpr int kMaxBlock = 64;
+
+  Oversampler();
+
+  /**
+   * @brief Sets the oversampling factor and clears the filter state.
+   * @param f 1, 2 or 4 (anything else is treated as 1)
+   */
+  void setFactor(int f);
+  int getFactor() const { return factor; }
+
+  /**
+   * @brief Clears the filter state (e.g. after a bypass).
+   */
+  void reset();
+
+  /**
+   * @brief Upsamples a block into the internal buffer.
+   * @param in Base-rate input (n values, n <= kMaxBlock)
+   * @param n Number of base-rate samples
+   * @return Oversampled buffer (n * getFactor() values), to be processed in place
+   */
+  float* up(const float* in, int n);
+
+  /**
+   * @brief Downsamples the internal buffer back to the base rate.
+   * @param out Base-rate output (n values)
+   * @param n Number of base-rate samples
+   */
+  void down(float* out, int n);
+
+private:
+  static constexpr int kStage1Taps = 10;  // 39-tap filter, 1x <-> 2x
+  static constexpr int kStage2Taps = 4;   // 15-tap filter, 2x <-> 4x
+  static const float kStage1Coeffs[kStage1Taps];
+  static const float kStage2Coeffs[kStage2Taps];
+
+  int factor = 1;
+  HalfbandUpsampler<kStage1Taps, kMaxBlock> up1;
+  HalfbandUpsampler<kStage2Taps, kMaxBlock * 2> up2;
+  HalfbandDownsampler<kStage2Taps, kMaxBlock * 2> down2;
+  HalfbandDownsampler<kStage1Taps, kMaxBlock> down1;
+
+  float buf2x[kMaxBlock * 2];
+  float buf4x[kMaxBlock * 4];
+};
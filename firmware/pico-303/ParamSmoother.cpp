@@ -0,0 +1,68 @@
+/**
+ * @file ParamSmoother.cpp
+ * @brief Implementation of the ParamSmoother class.
+ */
+
+#include "ParamSmoother.h"
+#include "HotPath.h"
+
+void ParamSmoother::configure(int id, float initial, float rampMs) {
+  Slot& s = slots[id];
+  s.rampSamples = rampMs * 0.001f * sampleRate;
+  if (s.rampSamples < 1.0f) s.rampSamples = 1.0f;
+  setImmediate(id, initial);
+}
+
+void ParamSmoother::setTarget(int id, float target) {
+  Slot& s = slots[id];
+  if (target == s.target) return;  // Already there or on the way
+  s.target = target;
+  s.remaining = (int)s.rampSamples;
+  s.step = (target - s.current) / s.remaining;
+  activeMask |= 1u << id;
+}
+
+void ParamSmoother::setImmediate(int id, float value) {
+  Slot& s = slots[id];
+  s.current = s.target = s.blockStart = value;
+  s.step = s.blockStep = 0.0f;
+  s.remaining = 0;
+  activeMask &= ~(1u << id);
+  pendingMask |= 1u << id;
+}
+
+void SYNTH_RAM_FUNC(ParamSmoother::advance)(int n) {
+  changedMask = pendingMask;
+  pendingMask = 0;
+
+  // Ramps that finished in the previous block hold still from now on
+  uint32_t settled = rampedMask & ~activeMask;
+  while (settled) {
+    int id = __builtin_ctz(settled);
+    settled &= settled - 1;
+    slots[id].blockStart = slots[id].current;
+    slots[id].blockStep = 0.0f;
+  }
+  rampedMask = activeMask;
+
+  uint32_t active = activeMask;
+  while (active) {
+    int id = __builtin_ctz(active);
+    active &= active - 1;
+
+    Slot& s = slots[id];
+    s.blockStart = s.current;
+    if (s.remaining <= n) {
+      // Land exactly on the target at the end of this block
+      s.blockStep = (s.target - s.current) / n;
+      s.current = s.target;
+      s.remaining = 0;
+      activeMask &= ~(1u << id);
+    } else {
+      s.blockStep = s.step;
+      s.current += s.step * n;
+      s.remaining -= n;
+    }
+    changedMask |= 1u << id;
+  }
+}
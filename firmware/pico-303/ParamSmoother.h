@@ -0,0 +1,88 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file ParamSmoother.h
+ * @brief Shared linear smoothing for control parameters.
+ */
+
+/**
+ * @class ParamSmoother
+ * @brief One table of current/target values, advanced once per sub-block.
+ * setTarget() starts a linear ramp over the slot's ramp time. advance() moves
+ * every active ramp forward by one sub-block and records, per slot, the value
+ * at the start of the block and the per-sample step across it, so only the
+ * destinations that need per-sample interpolation pay for it; everything else
+ * reads value() once per sub-block.
+ */
+class ParamSmoother {
+public:
+  static constexpr int kMaxParams = 32;
+
+  /**
+   * @brief Sets the sample rate (ramp times are converted to samples).
+   * @param sr Sample rate in Hz
+   */
+  void setSampleRate(float sr) { sampleRate = sr; }
+
+  /**
+   * @brief Configures a slot and jumps it to its initial value.
+   * @param id Slot index (< kMaxParams)
+   * @param initial Initial value
+   * @param rampMs Time a change takes to complete
+   */
+  void configure(int id, float initial, float rampMs);
+
+  /**
+   * @brief Starts a ramp from the current value to a new target.
+   * @param id Slot index
+   * @param target Target value
+   */
+  void setTarget(int id, float target);
+
+  /**
+   * @brief Jumps a slot to a value without ramping.
+   * @param id Slot index
+   * @param value New value
+   */
+  void setImmediate(int id, float value);
+
+  /**
+   * @brief Advances all active ramps by one sub-block.
+   * @param n Sub-block length in samples
+   */
+  void advance(int n);
+
+  /// Value at the end of the last advanced sub-block
+  float value(int id) const { return slots[id].current; }
+
+  /// Value at the start of the last advanced sub-block
+  float blockStart(int id) const { return slots[id].blockStart; }
+
+  /// Per-sample increment across the last advanced sub-block
+  float blockStep(int id) const { return slots[id].blockStep; }
+
+  /// Bitmask of slots that changed in the last advance() (or by setImmediate)
+  uint32_t changed() const { return changedMask; }
+
+  /// True while any slot is still ramping
+  bool isActive() const { return activeMask != 0; }
+
+private:
+  struct Slot {
+    float current = 0.0f;
+    float target = 0.0f;
+    float step = 0.0f;       // Per-sample ramp increment
+    float blockStart = 0.0f;
+    float blockStep = 0.0f;
+    float rampSamples = 1.0f;
+    int remaining = 0;       // Samples left in the ramp
+  };
+
+  Slot slots[kMaxParams];
+  float sampleRate = 44100.0f;
+  uint32_t activeMask = 0;
+  uint32_t changedMask = 0;
+  uint32_t pendingMask = 0;  // Jumped since the last advance()
+  uint32_t rampedMask = 0;   // Slots that ramped in the last advance()
+};
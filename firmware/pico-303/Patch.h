@@ -0,0 +1,78 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file Patch.h
+ * @brief Compact snapshot of the sound settings (the CC values the engine responds to).
+ */
+
+/**
+ * @struct Patch
+ * @brief The value of every sound CC plus which delay channels are tempo-synced.
+ * The control core keeps a live copy up to date from the CCs it forwards
+ * (setCc()); SynthEngine::applyPatch() sets all of them at once. A patch has
+ * one set of voice CCs, which applyPatch() gives to every voice.
+ */
+struct Patch {
+  /// CCs in a patch, in the order of values[]
+  static constexpr uint8_t kCcs[] = {
+    7, 14, 15, 16, 17, 18, 71, 74, 75, 77, 78, 79, 80, 81, 82, 83, 86, 91, 92, 93, 94, 100
+  };
+  static constexpr int kCcCount = sizeof(kCcs);
+
+  /// Engine startup sound in CC values (volume 0.6, cutoff 1 kHz, decay 1 s, 250 ms free delay, ...)
+  static constexpr uint8_t kDefaults[kCcCount] = {
+    127, 0, 64, 64, 85, 0, 0, 66, 62, 0, 0, 127, 0, 27, 38, 38, 32, 32, 32, 0, 0, 64
+  };
+
+  /// delaySync bits: the channel follows its sync division (CC 91/92) instead of
+  /// CC 81, with straight timing (set by CC 86) or with its modifier (CC 93/94)
+  enum : uint8_t { SYNC_LEFT = 1, SYNC_RIGHT = 2, STRAIGHT_LEFT = 4, STRAIGHT_RIGHT = 8 };
+
+  uint8_t values[kCcCount];
+  uint8_t delaySync = 0;
+
+  Patch() {
+    for (int i = 0; i < kCcCount; i++) values[i] = kDefaults[i];
+  }
+
+  /// Index of a CC in values[], -1 if it is not part of a patch
+  static int indexOf(uint8_t cc) {
+    for (int i = 0; i < kCcCount; i++) {
+      if (kCcs[i] == cc) return i;
+    }
+    return -1;
+  }
+
+  /// True for the CCs that every voice has its own copy of
+  static bool isVoiceCc(uint8_t cc) {
+    return (cc >= 14 && cc <= 18) || cc == 71 || cc == 74 || cc == 75 || cc == 100;
+  }
+
+  /// Value of a CC (0 if it is not part of a patch)
+  uint8_t cc(uint8_t number) const {
+    int i = indexOf(number);
+    return i < 0 ? 0 : values[i];
+  }
+
+  /**
+   * @brief Records a CC the way the engine applies it.
+   * CC 86 sets both sync divisions with straight timing, CC 81 frees both channels.
+   * @return false if the CC is not part of a patch
+   */
+  bool setCc(uint8_t number, uint8_t value) {
+    int i = indexOf(number);
+    if (i < 0) return false;
+    values[i] = value & 0x7F;
+    switch (number) {
+      case 81: delaySync = 0; break;
+      case 86:
+        values[indexOf(91)] = values[indexOf(92)] = values[i];
+        delaySync = SYNC_LEFT | SYNC_RIGHT | STRAIGHT_LEFT | STRAIGHT_RIGHT;
+        break;
+      case 91: case 93: delaySync = (delaySync | SYNC_LEFT) & ~STRAIGHT_LEFT; break;
+      case 92: case 94: delaySync = (delaySync | SYNC_RIGHT) & ~STRAIGHT_RIGHT; break;
+    }
+    return true;
+  }
+};
@@ -0,0 +1,44 @@
+/**
+ * @file PresetStore.cpp
+ * @brief Implementation of the PresetStore class.
+ */
+
+#include "PresetStore.h"
+#include <EEPROM.h>
+#include <stddef.h>
+
+void PresetStore::begin() {
+  EEPROM.begin(sizeof(Bank));
+  EEPROM.get(0, bank);
+  if (bank.magic != kMagic || bank.version != kVersion || bank.checksum != checksum(bank)) {
+    bank = Bank();
+    bank.magic = kMagic;
+    bank.version = kVersion;
+    bank.used = 0;
+  }
+}
+
+bool PresetStore::load(int slot, Patch& out) const {
+  if (slot < 0 || slot >= kSlots || !(bank.used & (1u << slot))) return false;
+  out = bank.slots[slot];
+  return true;
+}
+
+bool PresetStore::store(int slot, const Patch& patch) {
+  if (slot < 0 || slot >= kSlots) return false;
+  bank.slots[slot] = patch;
+  bank.used |= 1u << slot;
+  bank.checksum = checksum(bank);
+  EEPROM.put(0, bank);
+  return EEPROM.commit();  // Erase + program with the other core idled
+}
+
+uint32_t PresetStore::checksum(const Bank& b) {
+  // FNV-1a over everything before the checksum
+  const uint8_t* p = (const uint8_t*)&b;
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < offsetof(Bank, checksum); i++) {
+    h = (h ^ p[i]) * 16777619u;
+  }
+  return h;
+}
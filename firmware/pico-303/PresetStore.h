@@ -0,0 +1,66 @@
+#pragma once
+#include <stdint.h>
+
+#include "Patch.h"
+
+/**
+ * @file PresetStore.h
+ * @brief Preset slots in flash.
+ */
+
+// Preset slots (Program Change 0 ... PRESET_SLOTS - 1)
+#ifndef PRESET_SLOTS
+#define PRESET_SLOTS 16
+#endif
+
+/**
+ * @class PresetStore
+ * @brief PRESET_SLOTS patches in the flash sector of the EEPROM emulation,
+ * with a RAM copy for reading. Call from core 0 only.
+ *
+ * store() reprograms the sector. The EEPROM library parks the audio core in
+ * RAM and disables interrupts while the flash is erased (XIP is unavailable
+ * then), so the output drops out for the erase (tens of milliseconds).
+ */
+class PresetStore {
+public:
+  static constexpr int kSlots = PRESET_SLOTS;
+
+  /**
+   * @brief Reads the slots from flash. A missing or corrupted bank reads as empty slots.
+   */
+  void begin();
+
+  /**
+   * @brief Copies a slot.
+   * @param slot Slot number
+   * @param out Receives the patch
+   * @return false if the slot is out of range or empty
+   */
+  bool load(int slot, Patch& out) const;
+
+  /**
+   * @brief Writes a patch to a slot and commits the bank to flash.
+   * @param slot Slot number
+   * @param patch Patch to store
+   * @return false if the slot is out of range or the flash write failed
+   */
+  bool store(int slot, const Patch& patch);
+
+private:
+  static constexpr uint32_t kMagic = 0x33303350;  // "P303"
+  static constexpr uint16_t kVersion = 1;
+
+  struct Bank {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t used;  // Bit per slot (PRESET_SLOTS <= 16)
+    Patch slots[kSlots];
+    uint32_t checksum;
+  };
+  static_assert(kSlots <= 16, "PresetStore keeps one used bit per slot in 16 bits");
+
+  static uint32_t checksum(const Bank& b);
+
+  Bank bank;
+};
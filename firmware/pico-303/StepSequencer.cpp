@@ -0,0 +1,105 @@
+/**
+ * @file StepSequencer.cpp
+ * @brief Implementation of the StepSequencer class.
+ */
+
+#include "StepSequencer.h"
+#include "HotPath.h"
+#include <algorithm>
+
+void StepSequencer::setSampleRate(int sr) {
+  sampleRate = sr;
+  setTempo(tempo);
+}
+
+void StepSequencer::setTempo(float bpm) {
+  tempo = std::clamp(bpm, 20.0f, 300.0f);
+  // 16ths: sampleRate * 60 / (4 * bpm) frames per step, kept with a 16-bit
+  // fraction so a long run does not drift against the tempo
+  stepLengthQ16 = (int64_t)((double)sampleRate * 15.0 * 65536.0 / tempo);
+}
+
+void StepSequencer::setPattern(const Pattern& p) {
+  pattern = p;
+  pattern.length = std::clamp<uint8_t>(pattern.length, 1, kSteps);
+}
+
+void StepSequencer::setSync(Sync s) {
+  sync = s;
+  untilStepQ16 = 0;  // INTERNAL: next step at once
+}
+
+void StepSequencer::start() {
+  releaseNote();
+  running = true;
+  step = -1;
+  untilStepQ16 = 0;
+}
+
+void StepSequencer::stop() {
+  running = false;
+  releaseNote();
+}
+
+void StepSequencer::releaseNote() {
+  sliding = false;
+  untilGateOff = -1;
+  if (heldPitch == 0xFF) return;
+  push(false, heldPitch, 0);
+  heldPitch = 0xFF;
+}
+
+void StepSequencer::clockStep(uint32_t index) {
+  if (!running || sync != MIDI_CLOCK) return;
+  playStep((int)(index % pattern.length));
+}
+
+int SYNTH_RAM_FUNC(StepSequencer::framesToEvent)() const {
+  if (pendingRead < pendingCount) return 0;
+  int64_t n = kNoEvent;
+  if (running && sync == INTERNAL) n = std::min<int64_t>(n, (untilStepQ16 + 0xFFFF) >> 16);
+  if (untilGateOff >= 0) n = std::min<int64_t>(n, untilGateOff);
+  return n > 0 ? (int)n : 0;
+}
+
+void SYNTH_RAM_FUNC(StepSequencer::advance)(int frames) {
+  if (running && sync == INTERNAL) untilStepQ16 -= (int64_t)frames << 16;
+  if (untilGateOff > 0) untilGateOff = std::max(untilGateOff - frames, 0);
+}
+
+bool SYNTH_RAM_FUNC(StepSequencer::pop)(Event& ev) {
+  if (pendingRead == pendingCount) {
+    if (untilGateOff == 0) releaseNote();
+    if (running && sync == INTERNAL && untilStepQ16 <= 0) {
+      untilStepQ16 += stepLengthQ16;
+      playStep((step + 1) % pattern.length);
+    }
+    if (pendingRead == pendingCount) return false;
+  }
+  ev = pending[pendingRead++];
+  return true;
+}
+
+void StepSequencer::playStep(int index) {
+  step = index;
+  const Step& s = pattern.steps[index];
+
+  // Only a SLIDE step hands its note on; any other note still held ends here
+  if (!sliding) releaseNote();
+  if (!(s.flags & GATE)) {
+    releaseNote();
+    return;
+  }
+
+  const uint8_t from = heldPitch;
+  push(true, s.pitch, (s.flags & ACCENT) ? 127 : 63);
+  if (from != 0xFF) push(false, from, 0);  // After the new note on: it slides
+  heldPitch = s.pitch;
+  sliding = (s.flags & SLIDE) != 0;
+  untilGateOff = sliding ? -1 : std::max((int)(stepLengthQ16 >> 17), 1);  // Half a step
+}
+
+void StepSequencer::push(bool on, uint8_t pitch, uint8_t velocity) {
+  if (pendingRead == pendingCount) pendingRead = pendingCount = 0;
+  if (pendingCount < kMaxPending) pending[pendingCount++] = { on, pitch, velocity };
+}
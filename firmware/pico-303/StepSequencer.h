@@ -0,0 +1,136 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file StepSequencer.h
+ * @brief 16-step TB-303 style pattern sequencer, timed in samples.
+ */
+
+/**
+ * @class StepSequencer
+ * @brief Plays a Pattern as note on/off events at exact sample positions.
+ * The engine renders up to framesToEvent() frames, advance()s by them and
+ * applies the events pop() returns, so steps land on their sample whatever
+ * the block size.
+ *
+ * With INTERNAL sync the step length comes from setTempo() (16th notes).
+ * With MIDI_CLOCK sync clockStep() starts each step on its clock tick (every
+ * 6th, already placed at its sample offset by the event queue) and the tempo
+ * only sets the gate length.
+ *
+ * 303 timing: a gated step starts its note at the step start and releases it
+ * after half a step. A step with SLIDE holds its note into the next step,
+ * whose note then slides from it (same pitch = a tie).
+ */
+class StepSequencer {
+public:
+  static constexpr int kSteps = 16;
+
+  enum Flags : uint8_t {
+    GATE = 1,    ///< The step plays a note (else a rest)
+    ACCENT = 2,  ///< Accented (velocity 127 instead of 63)
+    SLIDE = 4    ///< Hold the note into the next step
+  };
+
+  struct Step {
+    uint8_t pitch = 36;  ///< MIDI note
+    uint8_t flags = 0;   ///< Flags
+  };
+
+  struct Pattern {
+    Step steps[kSteps];
+    uint8_t length = kSteps;  ///< Steps played [1 ... kSteps]
+    uint8_t channel = 1;      ///< MIDI channel of the notes (selects the voice)
+  };
+
+  enum Sync : uint8_t {
+    INTERNAL,   ///< Own tempo (setTempo())
+    MIDI_CLOCK  ///< Steps on the MIDI clock while the transport plays
+  };
+
+  /// A note for the engine
+  struct Event {
+    bool on;
+    uint8_t pitch;
+    uint8_t velocity;
+  };
+
+  /// Value framesToEvent() returns when nothing is scheduled
+  static constexpr int kNoEvent = 1 << 30;
+
+  void setSampleRate(int sr);
+
+  /**
+   * @brief Sets the tempo: the step length (INTERNAL) and the gate length.
+   * @param bpm Beats per minute, 4 steps per beat
+   */
+  void setTempo(float bpm);
+  float getTempo() const { return tempo; }
+
+  /// Replaces the pattern; a running sequence continues at its step index
+  void setPattern(const Pattern& p);
+  const Pattern& getPattern() const { return pattern; }
+
+  void setSync(Sync s);
+  Sync getSync() const { return sync; }
+
+  /**
+   * @brief Starts at step 0. With INTERNAL sync the first step plays at once;
+   * with MIDI_CLOCK sync it waits for clockStep().
+   */
+  void start();
+
+  /// Stops and releases a held note
+  void stop();
+
+  /// Releases a held note and keeps running (MIDI Stop with MIDI_CLOCK sync)
+  void releaseNote();
+
+  bool isRunning() const { return running; }
+  /// Step that played last
+  int getStep() const { return step; }
+
+  /**
+   * @brief Plays step index (MIDI_CLOCK sync, on every 6th tick).
+   * @param index Song position in 16ths (wraps over the pattern length)
+   */
+  void clockStep(uint32_t index);
+
+  /// Frames until the next scheduled event (0 if one is due, kNoEvent if none)
+  int framesToEvent() const;
+
+  /// Moves the sequencer forward by frames rendered frames
+  void advance(int frames);
+
+  /**
+   * @brief Returns the next due note event.
+   * @return false when nothing is due now
+   */
+  bool pop(Event& ev);
+
+private:
+  void playStep(int index);
+  void push(bool on, uint8_t pitch, uint8_t velocity);
+
+  Pattern pattern;
+  Sync sync = INTERNAL;
+  bool running = false;
+  int sampleRate = 44100;
+  float tempo = 120.0f;
+
+  // Step length and the time to the next step start, in 1/65536 frames
+  int64_t stepLengthQ16 = 0;
+  int64_t untilStepQ16 = 0;
+  int untilGateOff = -1;  // Frames until the held note is released (-1 = none)
+
+  int step = -1;
+  uint8_t heldPitch = 0xFF;  // Sounding note (0xFF = none)
+  bool sliding = false;      // heldPitch belongs to a SLIDE step
+
+  // Events of the current sample position (a release, a note on and the
+  // release of the note it slides from at most)
+  static constexpr int kMaxPending = 4;
+  Event pending[kMaxPending];
+  int pendingCount = 0;
+  int pendingRead = 0;
+};
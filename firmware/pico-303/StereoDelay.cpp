@@ -4,38 +4,60 @@
  */
 
 #include "StereoDelay.h"
+#include "HotPath.h"
+#include "FixedPoint.h"
 #include <cmath>
+#include <cstring>
 #include <algorithm>
 
-StereoDelay::StereoDelay(int maxDelay) 
-  : maxDelaySamples(maxDelay) {
+StereoDelay::StereoDelay(float maxDelayMs) 
+  : maxDelayMs(maxDelayMs) {
   // Do NOT allocate here. Global constructors run before heap is ready.
 }
 
 StereoDelay::~StereoDelay() {}
 
-bool StereoDelay::begin() {
-  // Allocate memory now
-  bufferL.resize(maxDelaySamples, 0.0f);
-  bufferR.resize(maxDelaySamples, 0.0f);
-  
-  // Calculate smoothing coefficient for 400ms ramp time
-  // Using one-pole lowpass: coeff = 1 - exp(-1 / (rampTime * sampleRate))
-  float rampTimeSec = 0.4f; // 400ms
-  smoothingCoeff = 1.0f - std::exp(-1.0f / (rampTimeSec * sampleRate));
-  
-  // Check if allocation succeeded (though std::vector usually throws)
-  return (bufferL.size() == maxDelaySamples && bufferR.size() == maxDelaySamples);
+int StereoDelay::maxDelayMsFor(size_t bytes, float sr) {
+  return (int)(bytes / sizeof(Frame) * 1000.0f / sr);
+}
+
+bool StereoDelay::begin(float sr, EffectArena& arena) {
+  sampleRate = sr;
+  maxDelaySamples = std::max(2, (int)(maxDelayMs * sr / 1000.0f));
+  writeIndex = 0;
+
+  frames = (Frame*)arena.reserve(maxDelaySamples * sizeof(Frame), "delay");
+  staged = nullptr;
+  if (frames && arena.isExternal()) {
+    staged = (Staging*)EffectArena::sram().reserve(sizeof(Staging), "delay staging");
+    if (!staged) frames = nullptr;
+    minDelaySamples = kBatchFrames + 2.0f;
+  }
+  if (!frames) {
+    maxDelaySamples = 2;  // Keeps the time clamps valid; process() passes the input through
+    return false;
+  }
+  clear();
+  return true;
+}
+
+void StereoDelay::clear() {
+  if (!frames) return;
+  if (staged) {
+    validFrames = 0;  // Read as zero once staged
+  } else {
+    std::fill(frames, frames + maxDelaySamples, pack(0.0f, 0.0f));
+    validFrames = maxDelaySamples;
+  }
+  silentFrames = maxDelaySamples;
 }
 
-void StereoDelay::setTimeSamplesL(int samples) {
-  // Set target, actual value will smoothly ramp in tick()
-  targetDelaySamplesL = std::max(1.0f, std::min((float)samples, (float)(maxDelaySamples - 1)));
+void StereoDelay::setTimeSamplesL(float samples) {
+  targetDelaySamplesL = std::max(minDelaySamples, std::min(samples, (float)(maxDelaySamples - 1)));
 }
 
-void StereoDelay::setTimeSamplesR(int samples) {
-  // Set target, actual value will smoothly ramp in tick()
-  targetDelaySamplesR = std::max(1.0f, std::min((float)samples, (float)(maxDelaySamples - 1)));
+void StereoDelay::setTimeSamplesR(float samples) {
+  targetDelaySamplesR = std::max(minDelaySamples, std::min(samples, (float)(maxDelaySamples - 1)));
 }
 
 void StereoDelay::setFeedback(float fb) {
@@ -46,41 +68,188 @@ void StereoDelay::setMix(float m) {
   mix = std::max(0.0f, std::min(m, 1.0f));
 }
 
-float StereoDelay::processL(float input) {
-  if (bufferL.empty()) return input; // Safety check
+float SYNTH_RAM_FUNC(StereoDelay::processL)(float input) {
+  if (!frames) return input; // Safety check
 
-  int readIndex = writeIndex - (int)delaySamplesL;
-  if (readIndex < 0) readIndex += maxDelaySamples;
-  
-  float delayed = bufferL[readIndex];
+  float frac;
+  int a = tapIndex(writeIndex, delaySamplesL, frac);
+  const int d = (int)delaySamplesL;
+  float newer = loadL(a, d);
+  float delayed = newer + frac * (loadL(prevIndex(a), d + 1) - newer);
   return (1.0f - mix) * input + mix * delayed;
 }
 
-float StereoDelay::processR(float input) {
-  if (bufferR.empty()) return input; // Safety check
+float SYNTH_RAM_FUNC(StereoDelay::processR)(float input) {
+  if (!frames) return input; // Safety check
 
-  int readIndex = writeIndex - (int)delaySamplesR;
-  if (readIndex < 0) readIndex += maxDelaySamples;
-  
-  float delayed = bufferR[readIndex];
+  float frac;
+  int a = tapIndex(writeIndex, delaySamplesR, frac);
+  const int d = (int)delaySamplesR;
+  float newer = loadR(a, d);
+  float delayed = newer + frac * (loadR(prevIndex(a), d + 1) - newer);
   return (1.0f - mix) * input + mix * delayed;
 }
 
-void StereoDelay::tick(float inL, float inR) {
-  if (bufferL.empty() || bufferR.empty()) return;
+void SYNTH_RAM_FUNC(StereoDelay::process)(float* left, float* right, int n) {
+  if (!frames) return;
+  if (staged) {
+    processStaged(left, right, n);
+    return;
+  }
+  processBlock(left, right, n, DirectLine{ frames }, targetDelaySamplesL, targetDelaySamplesR);
+}
 
-  // Smooth delay time changes (one-pole lowpass filter)
-  delaySamplesL += smoothingCoeff * (targetDelaySamplesL - delaySamplesL);
-  delaySamplesR += smoothingCoeff * (targetDelaySamplesR - delaySamplesR);
+template <class Line>
+void SYNTH_RAM_FUNC(StereoDelay::processBlock)(float* left, float* right, int n, Line line,
+                                               float endL, float endR) {
+  int w = writeIndex;
+  float dL = delaySamplesL;
+  float dR = delaySamplesR;
+  // Glide to the targets across this block
+  const float invN = 1.0f / n;
+  const float stepL = (endL - dL) * invN;
+  const float stepR = (endR - dR) * invN;
+  const float fb = feedback;
+  const float wet = mix;
+  const float dry = 1.0f - mix;
+  float peak = 0.0f;
 
-  int readIndexL = writeIndex - (int)delaySamplesL;
-  if (readIndexL < 0) readIndexL += maxDelaySamples;
-  
-  int readIndexR = writeIndex - (int)delaySamplesR;
-  if (readIndexR < 0) readIndexR += maxDelaySamples;
+  for (int i = 0; i < n; i++) {
+    float inL = left[i];
+    float inR = right[i];
+
+    dL += stepL;
+    dR += stepR;
+
+    // One interpolated tap per channel feeds both the output and the feedback
+    float fL, fR;
+    int aL = tapIndex(w, dL, fL);
+    int aR = tapIndex(w, dR, fR);
+    float newerL = frameL(line.tapL(aL));
+    float newerR = frameR(line.tapR(aR));
+    float delayedL = newerL + fL * (frameL(line.tapL(prevIndex(aL))) - newerL);
+    float delayedR = newerR + fR * (frameR(line.tapR(prevIndex(aR))) - newerR);
+
+    left[i] = dry * inL + wet * delayedL;
+    right[i] = dry * inR + wet * delayedR;
+
+    // Feedback with fast sigmoid saturation
+    float nextL = inL + delayedL * fb;
+    float nextR = inR + delayedR * fb;
+    float satL = nextL / (1.0f + std::abs(nextL));
+    float satR = nextR / (1.0f + std::abs(nextR));
+    line.put(w, pack(satL, satR));
+    peak = std::max(peak, std::max(std::abs(satL), std::abs(satR)));
+
+    if (++w >= maxDelaySamples) w = 0;
+  }
+
+  noteWritten(peak < 1.0f / 32767.0f, n);  // Stores as 0 in int16 frames
+  writeIndex = w;
+  delaySamplesL = endL;  // No rounding drift
+  delaySamplesR = endR;
+}
+
+#if STEREO_DELAY_INT16
+// x / (1 + |x|) for x in Q5.26, returned in Q15. The input is clamped to +-4
+// (0.8 out) so the Q29 numerator fits 32 bits.
+static inline int32_t saturateFeedback(int32_t x) {
+  int32_t q14 = fixp::sat<17>(x >> 12);
+  int32_t mag = q14 < 0 ? -q14 : q14;
+  return (q14 << 15) / (16384 + mag);
+}
+
+void SYNTH_RAM_FUNC(StereoDelay::process)(int32_t* left, int32_t* right, int n) {
+  if (!frames) return;
+  if (staged) {
+    processStaged(left, right, n);
+    return;
+  }
+  processBlock(left, right, n, DirectLine{ frames }, targetDelaySamplesL, targetDelaySamplesR);
+}
+
+template <class Line>
+void SYNTH_RAM_FUNC(StereoDelay::processBlock)(int32_t* left, int32_t* right, int n, Line line,
+                                               float endL, float endR) {
+  int w = writeIndex;
+  // Delay times in unsigned Q16.16 above a whole-sample base, so long lines fit
+  const int baseL = (int)std::min(delaySamplesL, endL);
+  const int baseR = (int)std::min(delaySamplesR, endR);
+  uint32_t dL = (uint32_t)((delaySamplesL - baseL) * 65536.0f);
+  uint32_t dR = (uint32_t)((delaySamplesR - baseR) * 65536.0f);
+  const int32_t stepL = (int32_t)((endL - delaySamplesL) * 65536.0f / n);
+  const int32_t stepR = (int32_t)((endR - delaySamplesR) * 65536.0f / n);
+  const int32_t fb = fixp::toQ(feedback, 30);
+  const int32_t wet = fixp::toQ(mix, 30);
+  const int32_t dry = fixp::toQ(1.0f - mix, 30);
+  uint32_t written = 0;
 
-  float delayedL = bufferL[readIndexL];
-  float delayedR = bufferR[readIndexR];
+  for (int i = 0; i < n; i++) {
+    int32_t inL = left[i];
+    int32_t inR = right[i];
+
+    dL += stepL;
+    dR += stepR;
+
+    int aL = w - baseL - (int)(dL >> 16);
+    int aR = w - baseR - (int)(dR >> 16);
+    if (aL < 0) aL += maxDelaySamples;
+    if (aR < 0) aR += maxDelaySamples;
+    uint32_t newerL = line.tapL(aL), olderL = line.tapL(prevIndex(aL));
+    uint32_t newerR = line.tapR(aR), olderR = line.tapR(prevIndex(aR));
+
+    // (1 - f) * newer + f * older in Q30, f in Q15
+    int32_t fL = (dL & 0xFFFF) >> 1;
+    int32_t fR = (dR & 0xFFFF) >> 1;
+    int32_t delayedL = fixp::dot16((newerL & 0xFFFF) | (olderL << 16), fixp::pack16(32767 - fL, fL)) >> 4;
+    int32_t delayedR = fixp::dot16((newerR >> 16) | (olderR & 0xFFFF0000u), fixp::pack16(32767 - fR, fR)) >> 4;
+
+    left[i] = fixp::mul<30>(dry, inL) + fixp::mul<30>(wet, delayedL);
+    right[i] = fixp::mul<30>(dry, inR) + fixp::mul<30>(wet, delayedR);
+
+    int32_t nextL = inL + fixp::mul<30>(fb, delayedL);
+    int32_t nextR = inR + fixp::mul<30>(fb, delayedR);
+    uint32_t frame = fixp::pack16(saturateFeedback(nextL), saturateFeedback(nextR));
+    line.put(w, frame);
+    written |= frame;
+
+    if (++w >= maxDelaySamples) w = 0;
+  }
+
+  noteWritten(written == 0, n);
+  writeIndex = w;
+  delaySamplesL = endL;
+  delaySamplesR = endR;
+}
+#else
+void SYNTH_RAM_FUNC(StereoDelay::process)(int32_t* left, int32_t* right, int n) {
+  // Longer blocks finish the delay time glide in their first 64 frames
+  float tmpL[64], tmpR[64];
+  for (int i = 0; i < n; i += 64) {
+    int m = std::min(64, n - i);
+    fixp::fromSignal(left + i, tmpL, m);
+    fixp::fromSignal(right + i, tmpR, m);
+    process(tmpL, tmpR, m);
+    fixp::toSignal(tmpL, left + i, m);
+    fixp::toSignal(tmpR, right + i, m);
+  }
+}
+#endif
+
+void SYNTH_RAM_FUNC(StereoDelay::tick)(float inL, float inR) {
+  if (!frames) return;
+
+  delaySamplesL = targetDelaySamplesL;
+  delaySamplesR = targetDelaySamplesR;
+
+  float fL, fR;
+  int aL = tapIndex(writeIndex, delaySamplesL, fL);
+  int aR = tapIndex(writeIndex, delaySamplesR, fR);
+  const int wholeL = (int)delaySamplesL, wholeR = (int)delaySamplesR;
+  float newerL = loadL(aL, wholeL);
+  float newerR = loadR(aR, wholeR);
+  float delayedL = newerL + fL * (loadL(prevIndex(aL), wholeL + 1) - newerL);
+  float delayedR = newerR + fR * (loadR(prevIndex(aR), wholeR + 1) - newerR);
 
   // Feedback with saturation
   float nextL = inL + delayedL * feedback;
@@ -92,9 +261,73 @@ void StereoDelay::tick(float inL, float inR) {
   nextL = nextL / (1.0f + std::abs(nextL));
   nextR = nextR / (1.0f + std::abs(nextR));
 
-  bufferL[writeIndex] = nextL;
-  bufferR[writeIndex] = nextR;
+  store(writeIndex, nextL, nextR);
+  noteWritten(std::max(std::abs(nextL), std::abs(nextR)) < 1.0f / 32767.0f, 1);
 
   writeIndex++;
   if (writeIndex >= maxDelaySamples) writeIndex = 0;
-}
\ No newline at end of file
+}
+
+template <typename T>
+void SYNTH_RAM_FUNC(StereoDelay::processStaged)(T* left, T* right, int n) {
+  for (int i = 0; i < n; i += kBatchFrames) {
+    const int m = std::min(kBatchFrames, n - i);
+    float endL, endR;
+    StagedLine line = stageBatch(m, endL, endR);
+    processBlock(left + i, right + i, m, line, endL, endR);
+    flushBatch(m);
+  }
+}
+
+StereoDelay::StagedLine SYNTH_RAM_FUNC(StereoDelay::stageBatch)(int n, float& endL, float& endR) {
+  // Glide at most kMaxGlide samples per batch; the rest follows in the next ones
+  const float g = (float)kMaxGlide;
+  endL = std::max(delaySamplesL - g, std::min(targetDelaySamplesL, delaySamplesL + g));
+  endR = std::max(delaySamplesR - g, std::min(targetDelaySamplesR, delaySamplesR + g));
+
+  // Frame i of the batch reads distances (d, d + 1] back from writeIndex + i,
+  // with d between the start and end times; 2 frames of margin for rounding
+  StagedLine line;
+  line.size = maxDelaySamples;
+  line.winL = staged->winL;
+  line.winR = staged->winR;
+  line.out = staged->out;
+  line.startOut = writeIndex;
+  const int farL = (int)std::max(delaySamplesL, endL) + 2;
+  const int farR = (int)std::max(delaySamplesR, endR) + 2;
+  const int nearL = std::max(1, (int)std::min(delaySamplesL, endL) - n - 1);
+  const int nearR = std::max(1, (int)std::min(delaySamplesR, endR) - n - 1);
+  line.startL = writeIndex - farL;
+  line.startR = writeIndex - farR;
+  if (line.startL < 0) line.startL += maxDelaySamples;
+  if (line.startR < 0) line.startR += maxDelaySamples;
+  stageWindow(staged->winL, farL, std::min(farL - nearL + 1, Staging::kWindow));
+  stageWindow(staged->winR, farR, std::min(farR - nearR + 1, Staging::kWindow));
+  return line;
+}
+
+void SYNTH_RAM_FUNC(StereoDelay::stageWindow)(Frame* win, int far, int count) const {
+  // win[0] is the frame `far` back from writeIndex; frames before the last clear() are zero
+  int zeros = std::min(count, std::max(0, far - validFrames));
+  std::fill(win, win + zeros, pack(0.0f, 0.0f));
+  int at = writeIndex - far + zeros;
+  if (at < 0) at += maxDelaySamples;
+  for (int j = zeros; j < count;) {
+    const int run = std::min(count - j, maxDelaySamples - at);
+    memcpy(win + j, frames + at, run * sizeof(Frame));
+    j += run;
+    at = 0;
+  }
+}
+
+void SYNTH_RAM_FUNC(StereoDelay::flushBatch)(int n) {
+  // processBlock() has advanced writeIndex past the batch
+  int at = writeIndex - n;
+  if (at < 0) at += maxDelaySamples;
+  for (int j = 0; j < n;) {
+    const int run = std::min(n - j, maxDelaySamples - at);
+    memcpy(frames + at, staged->out + j, run * sizeof(Frame));
+    j += run;
+    at = 0;
+  }
+}
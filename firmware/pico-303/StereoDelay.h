@@ -1,5 +1,14 @@
 #pragma once
-#include <vector>
+#include <stdint.h>
+#include <algorithm>
+
+#include "EffectArena.h"
+
+// 1 = store the delay line as packed 16-bit stereo frames (half the RAM of float),
+// 0 = interleaved float frames
+#ifndef STEREO_DELAY_INT16
+#define STEREO_DELAY_INT16 1
+#endif
 
 /**
  * @file StereoDelay.h
@@ -9,35 +18,81 @@
 /**
  * @class StereoDelay
  * @brief Implements a stereo delay line with independent left/right delay times.
- * Uses std::vector for buffer management to allow dynamic allocation.
+ * The line is reserved from an EffectArena in begin().
+ * L/R are stored interleaved (one frame = one 32-bit word in int16 mode) and
+ * read with linear interpolation, so smoothed delay time changes glide
+ * instead of stepping across whole samples.
+ *
+ * In an external arena (PSRAM) the block process() works in batches of up to
+ * kBatchFrames: it copies the span of the line that the block's taps can
+ * reach into SRAM, runs the usual loop on those copies and writes the new
+ * frames back in one go. The delay time is then at least kBatchFrames + 2, so
+ * no tap reaches into the batch being written, and a time change glides by at
+ * most kMaxGlide samples per batch.
  */
 class StereoDelay {
 public:
   /**
    * @brief Constructor.
-   * @param maxDelay Maximum delay length in samples (default 44100 = 1 sec at 44.1kHz)
+   * @param maxDelayMs Maximum delay length in milliseconds (the buffer is sized in begin())
    */
-  StereoDelay(int maxDelay = 44100);
+  StereoDelay(float maxDelayMs = 1000.0f);
   ~StereoDelay();
 
   /**
-   * @brief Allocates memory for the delay buffers.
-   * Must be called in setup(), not global scope.
-   * @return true if allocation succeeded
+   * @brief Sets the maximum delay length; takes effect at the next begin().
+   * @param ms Maximum delay length in milliseconds
+   */
+  void setMaxDelayMs(float ms) { maxDelayMs = ms; }
+
+  /// Frames per staged batch of an external line
+  static constexpr int kBatchFrames = 256;
+  /// Largest delay time glide per batch of an external line
+  static constexpr int kMaxGlide = 256;
+
+  /**
+   * @brief Reserves the delay line (maxDelayMs at the given rate) from an arena.
+   * Call once, from setup(). An external arena also reserves the staging
+   * buffers (about 5 KB) from EffectArena::sram().
+   * @param sr Sample rate in Hz
+   * @param arena Arena that holds the line
+   * @return true if the reservation succeeded
    */
-  bool begin(); 
+  bool begin(float sr, EffectArena& arena = EffectArena::sram());
+
+  /**
+   * @brief Longest delay line that fits in a number of bytes.
+   * @param bytes Space for the line
+   * @param sr Sample rate in Hz
+   * @return Length in milliseconds
+   */
+  static int maxDelayMsFor(size_t bytes, float sr);
+
+  /// True if the line is in external memory and processed in staged batches
+  bool isStaged() const { return staged != nullptr; }
+
+  /// Buffer length in frames (valid after begin())
+  int getMaxDelaySamples() const { return maxDelaySamples; }
+
+  /**
+   * @brief Silences the delay line (drops all pending echoes). An external line
+   * is not written: its stale frames read as zero until they are overwritten.
+   */
+  void clear();
 
   /**
    * @brief Sets the left channel delay time.
-   * @param samples Delay time in samples
+   * The block process() glides linearly to it across the next block; the
+   * per-sample path jumps. Smooth changes by calling this once per sub-block.
+   * @param samples Delay time in samples (fractional)
    */
-  void setTimeSamplesL(int samples);
+  void setTimeSamplesL(float samples);
 
   /**
-   * @brief Sets the right channel delay time.
-   * @param samples Delay time in samples
+   * @brief Sets the right channel delay time (see setTimeSamplesL).
+   * @param samples Delay time in samples (fractional)
    */
-  void setTimeSamplesR(int samples);
+  void setTimeSamplesR(float samples);
 
   /**
    * @brief Sets the feedback amount.
@@ -73,15 +128,131 @@ public:
    */
   void tick(float inL, float inR);
 
+  /**
+   * @brief Processes a block of stereo frames in place.
+   * Like processL/processR/tick per frame, but the output and the feedback
+   * share one interpolated tap per channel (read after the smoothing step).
+   * @param left Left input (dry) / output (mixed) buffer (n values)
+   * @param right Right input (dry) / output (mixed) buffer (n values)
+   * @param n Number of frames
+   */
+  void process(float* left, float* right, int n);
+
+  /**
+   * @brief Fixed-point block process on Q5.26 buffers (see FixedPoint.h).
+   * With int16 frames the taps are interpolated with one dual 16-bit MAC per
+   * channel straight from the Q15 frames and the feedback saturator clamps its
+   * input to +-4; float frames run the float path on a converted copy.
+   * @param left Left input (dry) / output (mixed) buffer (n values)
+   * @param right Right input (dry) / output (mixed) buffer (n values)
+   * @param n Number of frames
+   */
+  void process(int32_t* left, int32_t* right, int n);
+
+  /**
+   * @brief True once both lines have held only silence (below 1 LSB of int16)
+   * for a full buffer length, so a silent input gives a silent output.
+   */
+  bool isIdle() const { return silentFrames >= maxDelaySamples; }
+
+  /**
+   * @brief Skips a block of silent input while idle (see isIdle()).
+   * Delay time changes take effect at once instead of gliding.
+   */
+  void skip() {
+    delaySamplesL = targetDelaySamplesL;
+    delaySamplesR = targetDelaySamplesR;
+  }
+
 private:
-  std::vector<float> bufferL;
-  std::vector<float> bufferR;
-  int maxDelaySamples;
+  // Frame storage. Stored samples are already saturated to (-1, 1).
+#if STEREO_DELAY_INT16
+  typedef uint32_t Frame;  // L in the low half, R in the high half (Q15)
+
+  static inline float frameL(Frame f) { return (int16_t)(f & 0xFFFF) * (1.0f / 32767.0f); }
+  static inline float frameR(Frame f) { return (int16_t)(f >> 16) * (1.0f / 32767.0f); }
+  static inline Frame pack(float l, float r) {
+    return (uint32_t)(uint16_t)(int16_t)(l * 32767.0f) |
+           ((uint32_t)(uint16_t)(int16_t)(r * 32767.0f) << 16);
+  }
+#else
+  struct Frame { float l, r; };  // Interleaved L/R
+
+  static inline float frameL(Frame f) { return f.l; }
+  static inline float frameR(Frame f) { return f.r; }
+  static inline Frame pack(float l, float r) { return { l, r }; }
+#endif
+  Frame* frames = nullptr;
+
+  // Per-sample access (processL/R, tick); frames older than validFrames read as 0
+  inline float loadL(int i, int distance) const { return distance <= validFrames ? frameL(frames[i]) : 0.0f; }
+  inline float loadR(int i, int distance) const { return distance <= validFrames ? frameR(frames[i]) : 0.0f; }
+  inline void store(int i, float l, float r) { frames[i] = pack(l, r); }
+
+  /// Block access to a line in SRAM: taps and writes go straight to frames
+  struct DirectLine {
+    Frame* f;
+    inline Frame tapL(int i) const { return f[i]; }
+    inline Frame tapR(int i) const { return f[i]; }
+    inline void put(int i, Frame v) { f[i] = v; }
+  };
+
+  /// Block access to a batch of an external line, staged in SRAM
+  struct StagedLine {
+    const Frame* winL;  // Span of the line the left taps reach, from startL
+    const Frame* winR;
+    Frame* out;         // Frames written by the batch, from startOut
+    int startL, startR, startOut, size;
+    inline int rel(int i, int start) const { int r = i - start; return r < 0 ? r + size : r; }
+    inline Frame tapL(int i) const { return winL[rel(i, startL)]; }
+    inline Frame tapR(int i) const { return winR[rel(i, startR)]; }
+    inline void put(int i, Frame v) { out[rel(i, startOut)] = v; }
+  };
+
+  /// SRAM staging buffers of an external line
+  struct Staging {
+    static constexpr int kWindow = kBatchFrames + kMaxGlide + 4;
+    Frame winL[kWindow];
+    Frame winR[kWindow];
+    Frame out[kBatchFrames];
+  };
+  Staging* staged = nullptr;
+
+  template <class Line> void processBlock(float* left, float* right, int n, Line line, float endL, float endR);
+#if STEREO_DELAY_INT16
+  template <class Line> void processBlock(int32_t* left, int32_t* right, int n, Line line, float endL, float endR);
+#endif
+  template <typename T> void processStaged(T* left, T* right, int n);
+  StagedLine stageBatch(int n, float& endL, float& endR);
+  void stageWindow(Frame* win, int start, int count) const;
+  void flushBatch(int n);
+
+  /**
+   * @brief Splits a delay time into the newer tap index and the interpolation fraction.
+   * The older tap is the index before it (wrapped).
+   */
+  inline int tapIndex(int w, float delay, float& frac) const {
+    int whole = (int)delay;
+    frac = delay - whole;
+    int idx = w - whole;
+    return idx < 0 ? idx + maxDelaySamples : idx;
+  }
+
+  inline int prevIndex(int idx) const { return idx == 0 ? maxDelaySamples - 1 : idx - 1; }
+
+  /// Counts the frames written since the line last held a non-silent one
+  inline void noteWritten(bool silent, int n) {
+    silentFrames = silent ? std::min(silentFrames + n, maxDelaySamples) : 0;
+    validFrames = std::min(validFrames + n, maxDelaySamples);
+  }
+
+  float maxDelayMs;
+  int maxDelaySamples = 0;
   int writeIndex = 0;
   
   float sampleRate = 44100.0f;
   
-  // Current delay times (smoothed)
+  // Current delay times (reached at the end of each block)
   float delaySamplesL = 10000.0f;
   float delaySamplesR = 10000.0f;
   
@@ -89,9 +260,10 @@ private:
   float targetDelaySamplesL = 10000.0f;
   float targetDelaySamplesR = 10000.0f;
   
-  // Smoothing coefficient (calculated from ramp time)
-  float smoothingCoeff = 0.0f;
-  
   float feedback = 0.3f;
   float mix = 0.3f;
+
+  int silentFrames = 0;  // Consecutive silent frames written (capped at the line length)
+  int validFrames = 0;   // Frames written since the last clear() (capped at the line length)
+  float minDelaySamples = 1.0f;
 };
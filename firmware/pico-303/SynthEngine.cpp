@@ -0,0 +1,728 @@
+/**
+ * @file SynthEngine.cpp
+ * @brief Implementation of the SynthEngine class.
+ */
+
+#include "SynthEngine.h"
+#include "HotPath.h"
+#include "ControlCurves.h"
+#include <cmath>
+#include <algorithm>
+
+bool SynthEngine::begin(const AudioConfig& cfg) {
+  config = cfg;
+  sampleRate = cfg.sampleRate;
+
+  for (int v = 0; v < kMaxVoices; v++) {
+    // Osc
+    voices.osc[v].setSampleRate(sampleRate);
+    voices.osc[v].setWaveform(Oscillator::SQUARE);
+    voices.osc[v].setMode(true); // Enable JC303 mode (Square = Pulse 53%)
+    voices.envAmp[v].setSampleRate(sampleRate);
+    voices.envAmp[v].setDecay(300.0f);    // 300ms
+    voices.envAmp[v].setRelease(kReleaseMs);
+    voices.envFilt[v].setSampleRate(sampleRate);
+    voices.envFilt[v].setDecayTime(voices.voice[v].userDecayTime);
+    voices.voice[v].userDecayCoeff = DecayEnvelope::coeffFor(voices.voice[v].userDecayTime, sampleRate);
+
+    voices.filter[v].setSampleRate(sampleRate);
+    voices.filter[v].setEnvMod(500.0f);      // how much the envelope modulates cutoff
+
+    // Let's use 2.0ms to be safe and smooth.
+    voices.ampDeClicker[v].setSampleRate(sampleRate);
+    voices.ampDeClicker[v].setTimeConstant(2.0f);
+
+    // Post-filter HPF to remove DC offset (crucial for distortion)
+    voices.hpfPostFilter[v].setSampleRate(sampleRate);
+    voices.hpfPostFilter[v].setCutoff(30.0f); // ~25-30Hz like Open303
+  }
+
+  voices.settleFrames = sampleRate / 50;  // 20 ms
+  sequencer.setSampleRate(sampleRate);
+
+  accentDecayCoeff = DecayEnvelope::coeffFor(kAccentDecayMs, sampleRate);
+  releaseCoeff = AnalogEnvelope::coeffFor(kReleaseMs, sampleRate);
+  accentReleaseCoeff = AnalogEnvelope::coeffFor(kAccentReleaseMs, sampleRate);
+
+  // A long line goes to PSRAM when the sketch has set up that arena
+  EffectArena& delayArena = EffectArena::psram().capacity() ? EffectArena::psram() : EffectArena::sram();
+  stereoDelay.setMaxDelayMs((float)cfg.maxDelayMs);
+  bool ok = stereoDelay.begin((float)sampleRate, delayArena);
+  maxDelaySamples = stereoDelay.getMaxDelaySamples();
+  delayTimeSamplesL = delayTimeSamplesR = std::min(msToSamples(kDelayDefaultMs), maxDelaySamples - 1);
+
+  // Initial values of all smoothed CC destinations (applied before the first block)
+  smoothed.setSampleRate(sampleRate);
+  smoothed.configure(SP_VOLUME, 0.6f, 20.0f);
+  smoothed.configure(SP_DIST_AMOUNT, 0.0f, 20.0f);
+  smoothed.configure(SP_DIST_MIX, 1.0f, 20.0f);
+  smoothed.configure(SP_DELAY_FEEDBACK, 0.3f, 20.0f);
+  smoothed.configure(SP_DELAY_MIX, 0.3f, 20.0f);
+  smoothed.configure(SP_DELAY_TIME_L, (float)delayTimeSamplesL, 400.0f);  // Slow glide, like tape
+  smoothed.configure(SP_DELAY_TIME_R, (float)delayTimeSamplesR, 400.0f);
+  for (int v = 0; v < kMaxVoices; v++) {
+    smoothed.configure(voiceSlot(v, VP_SUB_BLEND), 0.0f, 20.0f);
+    smoothed.configure(voiceSlot(v, VP_WAVE_BLEND), 0.0f, 20.0f);
+    smoothed.configure(voiceSlot(v, VP_CUTOFF), 1000.0f, 20.0f);
+    smoothed.configure(voiceSlot(v, VP_RESONANCE), 0.0f, 20.0f);
+  }
+
+  return ok;
+}
+
+void SynthEngine::setVoiceCount(int n) {
+  n = std::clamp(n, 1, kMaxVoices);
+  // Voices that drop out are released, so they come back silent
+  for (int v = n; v < voices.count; v++) {
+    voices.envAmp[v].noteOff();
+    voices.voice[v].prevNote = 0xFF;
+    voices.voice[v].noteOverlap = 0;
+  }
+  voices.count = n;
+}
+
+void SYNTH_RAM_FUNC(SynthEngine::render)(int16_t* out, int frames) {
+  while (frames > 0) {
+    // Short sub-blocks only while a parameter is ramping; a chunk also ends
+    // at the next sequencer event
+    int n = std::min(frames, smoothed.isActive() ? kControlBlock : kMaxFrames);
+    n = std::min(n, runSequencer());
+    renderChunk(out, n);
+    sequencer.advance(n);
+    out += n * 2;
+    frames -= n;
+  }
+}
+
+/**
+ * @brief Plays the sequencer notes due at the current sample.
+ * @return Frames until its next event (at least 1)
+ */
+int SYNTH_RAM_FUNC(SynthEngine::runSequencer)() {
+  StepSequencer::Event ev;
+  const uint8_t channel = sequencer.getPattern().channel;
+  while (sequencer.pop(ev)) {
+    if (ev.on) noteOn(channel, ev.pitch, ev.velocity);
+    else noteOff(channel, ev.pitch, 0);
+  }
+  return std::max(sequencer.framesToEvent(), 1);
+}
+
+/**
+ * @brief Renders up to kMaxFrames frames as block passes:
+ * voices (osc -> filter -> HPF -> VCA) -> mix -> dist -> delay -> clip.
+ */
+void SYNTH_RAM_FUNC(SynthEngine::renderChunk)(int16_t* out, int n) {
+  uint32_t t = profileClock ? profileClock() : 0;
+
+  smoothed.advance(n);
+  applySmoothed();
+
+  // Each stage below runs either the float or the fixed-point (Q5.26) kernel
+  const bool fixed = kernelSet == KERNELS_FIXED;
+
+  // Nothing sounding and the delay has died out: skip the whole chain
+  const int sounding = voices.updateSilence(n);
+  if (sounding == 0 && stereoDelay.isIdle()) {
+    std::fill(out, out + 2 * n, (int16_t)0);
+    distFx.skip();
+    stereoDelay.skip();
+    markStage(STAGE_OUTPUT, t);
+    return;
+  }
+
+  // Voices. With sharing on, the upper half is offered to the other core; the
+  // lower half (and the offer, if nobody took it) is rendered here.
+  const int count = voices.count;
+  int split = count;
+  if (voiceSharing && count > 1) {
+    split = count / 2;
+    while (split < count && voices.silent[split]) split++;  // Don't post silent voices
+  }
+  if (split < count) {
+    jobFirst = split;
+    jobLast = count;
+    jobFrames = n;
+    jobState.store(JOB_POSTED, std::memory_order_release);
+  }
+  t = renderVoices(0, split, n, t, true);
+  if (split < count) {
+    uint32_t expected = JOB_POSTED;
+    if (jobState.compare_exchange_strong(expected, JOB_CLAIMED, std::memory_order_acquire)) {
+      t = renderVoices(split, count, n, t, true);
+    } else {
+      while (jobState.load(std::memory_order_acquire) != JOB_DONE) {
+      }
+      if (profileClock) t = profileClock();  // The wait is idle time, not a stage
+    }
+    jobState.store(JOB_IDLE, std::memory_order_relaxed);
+  }
+
+  // Mix onto the first sounding voice (a single voice passes through untouched)
+  int base = 0;
+  while (base < count && voices.silent[base]) base++;
+  if (base == count) {
+    // Only the delay tail is left
+    base = 0;
+    if (fixed) std::fill(voices.outQ[0], voices.outQ[0] + n, 0);
+    else std::fill(voices.out[0], voices.out[0] + n, 0.0f);
+  }
+  float* voiceBuf = voices.out[base];
+  int32_t* voiceQ = voices.outQ[base];
+  for (int v = base + 1; v < count; v++) {
+    if (voices.silent[v]) continue;
+    if (fixed) {
+      const int32_t* src = voices.outQ[v];
+      for (int i = 0; i < n; i++) voiceQ[i] += src[i];
+    } else {
+      const float* src = voices.out[v];
+      for (int i = 0; i < n; i++) voiceBuf[i] += src[i];
+    }
+  }
+
+  // Apply Distortion (Post-VCA). It is always float; the fixed chain only
+  // converts while it is active.
+  if (!fixed) {
+    distFx.process(voiceBuf, n);
+  } else if (distFx.isActive()) {
+    fixp::fromSignal(voiceQ, voiceBuf, n);
+    distFx.process(voiceBuf, n);
+    fixp::toSignal(voiceBuf, voiceQ, n);
+  } else {
+    distFx.process(voiceBuf, n);  // Bypassed: only notes the idle block
+  }
+  t = markStage(STAGE_DIST, t);
+
+  // Volume is the one destination interpolated per sample
+  float vol = smoothed.blockStart(SP_VOLUME);
+  const float volStep = smoothed.blockStep(SP_VOLUME);
+  if (fixed) {
+    int32_t volQ = fixp::toQ(vol, 31);
+    const int32_t volStepQ = fixp::toQ(volStep, 31);
+    for (int i = 0; i < n; i++) {
+      volQ += volStepQ;
+      int32_t sample = fixp::mul<31>(voiceQ[i], volQ);
+      outQL[i] = sample;
+      outQR[i] = sample;
+    }
+    stereoDelay.process(outQL, outQR, n);
+  } else {
+    for (int i = 0; i < n; i++) {
+      vol += volStep;
+      float sample = voiceBuf[i] * vol;
+      outBufL[i] = sample;
+      outBufR[i] = sample;
+    }
+    stereoDelay.process(outBufL, outBufR, n);
+  }
+  t = markStage(STAGE_DELAY, t);
+
+  // Soft Clipper on final output, stored in interleaved stereo buffer
+  if (fixed) outputStage.process(outQL, outQR, out, n);
+  else outputStage.process(outBufL, outBufR, out, n);
+  markStage(STAGE_OUTPUT, t);
+}
+
+/**
+ * @brief Renders the sounding voices of [first, last) into their block
+ * buffers, one stage at a time across the voices.
+ * @param t Profile clock at entry
+ * @param timed Adds the stage times to the stage stats (audio core only)
+ * @return Profile clock after the last stage
+ */
+uint32_t SYNTH_RAM_FUNC(SynthEngine::renderVoices)(int first, int last, int n, uint32_t t, bool timed) {
+  auto mark = [&](Stage s) { if (timed) t = markStage(s, t); };
+  const bool fixed = kernelSet == KERNELS_FIXED;
+
+  // Envelopes and oscillator
+  for (int v = first; v < last; v++) {
+    if (voices.silent[v]) continue;
+    voices.envAmp[v].process(voices.envAmpBuf[v], n);
+    voices.envFilt[v].process(voices.envFiltBuf[v], n);
+  }
+  mark(STAGE_ENV);
+
+  for (int v = first; v < last; v++) {
+    if (voices.silent[v]) continue;
+    if (fixed) voices.osc[v].process(voices.outQ[v], n);
+    else voices.osc[v].process(voices.out[v], n);
+  }
+  mark(STAGE_OSC);
+
+  // Filter, then remove DC offset caused by resonance *before* VCA/Distortion
+  for (int v = first; v < last; v++) {
+    if (voices.silent[v]) continue;
+    const float accentEnv = voices.voice[v].lastNoteWasAccented ? 1.0f : 0.0f;
+    if (fixed) {
+      voices.filter[v].process(voices.outQ[v], voices.envFiltBuf[v], n, accentEnv);
+      voices.hpfPostFilter[v].processHPF(voices.outQ[v], n);
+    } else {
+      voices.filter[v].process(voices.out[v], voices.envFiltBuf[v], n, accentEnv);
+      voices.hpfPostFilter[v].processHPF(voices.out[v], n);
+    }
+  }
+  mark(STAGE_FILTER);
+
+  for (int v = first; v < last; v++) {
+    if (voices.silent[v]) continue;
+    float* envAmpBuf = voices.envAmpBuf[v];
+    const float* envFiltBuf = voices.envFiltBuf[v];
+
+    // VCA Mixing (Open303 Style). Gate state only changes on events, which
+    // always fall on chunk boundaries, so it is constant here.
+    if (voices.envAmp[v].isActive()) {
+      const float filtEnvGain = 0.45f + voices.voice[v].currentAccentGain * 3.0f;
+      for (int i = 0; i < n; i++) envAmpBuf[i] += filtEnvGain * envFiltBuf[i];
+    }
+
+    // Smooth the VCA signal to remove clicks, then apply VCA *before* Distortion
+    if (fixed) {
+      int32_t* voiceQ = voices.outQ[v];
+      int32_t* ampQ = voices.ampQ[v];
+      fixp::toSignal(envAmpBuf, ampQ, n);
+      voices.ampDeClicker[v].process(ampQ, n);
+      for (int i = 0; i < n; i++) voiceQ[i] = fixp::mul<fixp::kSignalBits>(voiceQ[i], ampQ[i]);
+    } else {
+      float* voiceBuf = voices.out[v];
+      voices.ampDeClicker[v].process(envAmpBuf, n);
+      for (int i = 0; i < n; i++) voiceBuf[i] *= envAmpBuf[i];
+    }
+  }
+  mark(STAGE_VCA);
+  return t;
+}
+
+bool SYNTH_RAM_FUNC(SynthEngine::runVoiceJob)() {
+  uint32_t expected = JOB_POSTED;
+  if (!jobState.compare_exchange_strong(expected, JOB_CLAIMED, std::memory_order_acquire)) {
+    return false;
+  }
+  renderVoices(jobFirst, jobLast, jobFrames, 0, false);
+  jobState.store(JOB_DONE, std::memory_order_release);
+  return true;
+}
+
+/**
+ * @brief Pushes the smoothed values that moved in this sub-block to their destinations.
+ */
+void SYNTH_RAM_FUNC(SynthEngine::applySmoothed)() {
+  const uint32_t changed = smoothed.changed();
+  if (!changed) return;
+
+  auto moved = [changed](int slot) { return (changed >> slot) & 1u; };
+  if (moved(SP_DIST_AMOUNT))    distFx.setAmount(smoothed.value(SP_DIST_AMOUNT));
+  if (moved(SP_DIST_MIX))       distFx.setMix(smoothed.value(SP_DIST_MIX));
+  if (moved(SP_DELAY_FEEDBACK)) stereoDelay.setFeedback(smoothed.value(SP_DELAY_FEEDBACK));
+  if (moved(SP_DELAY_MIX))      stereoDelay.setMix(smoothed.value(SP_DELAY_MIX));
+  // The delay glides across the block itself
+  if (moved(SP_DELAY_TIME_L))   stereoDelay.setTimeSamplesL(smoothed.value(SP_DELAY_TIME_L));
+  if (moved(SP_DELAY_TIME_R))   stereoDelay.setTimeSamplesR(smoothed.value(SP_DELAY_TIME_R));
+
+  if (!(changed >> SP_VOICE_BASE)) return;
+  for (int v = 0; v < voices.count; v++) {
+    const int sub = voiceSlot(v, VP_SUB_BLEND), wave = voiceSlot(v, VP_WAVE_BLEND);
+    const int cutoff = voiceSlot(v, VP_CUTOFF), reso = voiceSlot(v, VP_RESONANCE);
+    if (moved(sub))    voices.osc[v].setSubBlend(smoothed.value(sub));
+    if (moved(wave))   voices.osc[v].setBlend(smoothed.value(wave));
+    if (moved(cutoff)) voices.filter[v].setCutoff(smoothed.value(cutoff));
+    if (moved(reso))   voices.filter[v].setResonance(smoothed.value(reso));
+  }
+}
+
+void SynthEngine::resetStageTicks() {
+  for (int i = 0; i < STAGE_COUNT; i++) stageTicks[i] = 0;
+}
+
+/**
+ * @brief Note On.
+ * Triggers envelopes, sets frequency, and handles accent/slide logic.
+ * 
+ * @param channel MIDI channel (1-16), selects the voice
+ * @param pitch MIDI note number (0-127)
+ * @param velocity Note velocity (0-127)
+ */
+void SynthEngine::noteOn(uint8_t channel, uint8_t pitch, uint8_t velocity) {
+  const int v = voices.forChannel(channel);
+  Voice& vs = voices.voice[v];
+
+  bool slide = (vs.prevNote != 0xFF);
+  bool accent = (velocity >= 100);
+
+  // Modified‑Naive overlap counter
+  if (vs.prevNote == pitch) vs.noteOverlap++;
+  vs.prevNote = pitch;
+
+  float freq = curves::kNoteHz[pitch & 0x7F] * vs.pitchRatio;
+  voices.osc[v].glideTo(freq, slide ? vs.glideTimeMs : 0.0f);  // use configurable glide time
+
+  // Accent and envelope logic
+  if (!slide || accent) {
+    if (!slide) {
+      voices.osc[v].resetPhase();
+    }
+    voices.envAmp[v].setReleaseCoeff(accent ? accentReleaseCoeff : releaseCoeff);
+    voices.envAmp[v].noteOn();
+    
+    // Use user-set decay time for normal notes, fixed 200ms for accent (TB-303 behavior)
+    voices.envFilt[v].setCoeff(accent ? accentDecayCoeff : vs.userDecayCoeff);
+    voices.envFilt[v].trigger();
+    
+    // Calculate accent gain for this note
+    vs.currentAccentGain = accent ? vs.accentLevel : 0.0f;
+    
+    // Filter modulation
+    // Base mod + Accent mod
+    // If accentLevel is 1.0, we want max boost (e.g. 2.5x total or similar)
+    // Old logic: accentBoost 1.0..2.5
+    // New logic: 1.0 + accentLevel * 1.5
+    float boost = 1.0f + vs.currentAccentGain * 1.5f;
+    float modAmt = vs.globalEnvMod * boost;
+    
+    modAmt = std::min(modAmt, 3000.0f);  // cap to prevent filter overload
+    voices.filter[v].setEnvMod(modAmt);
+  }
+
+  vs.lastNoteWasAccented = accent;
+}
+
+/**
+ * @brief Note Off.
+ * Manages note overlap for legato playing and triggers release phase.
+ * 
+ * @param channel MIDI channel, selects the voice
+ * @param pitch MIDI note number
+ * @param velocity Release velocity
+ */
+bool SynthEngine::noteOff(uint8_t channel, uint8_t pitch, uint8_t velocity) {
+  const int v = voices.forChannel(channel);
+  Voice& vs = voices.voice[v];
+
+  // Modified‑Naive: decrement overlap before noteOff
+  if (vs.prevNote == pitch) {
+    if (vs.noteOverlap > 0) {
+      vs.noteOverlap--;
+      return false;
+    }
+    // If no overlap left, stop tone
+    vs.prevNote = 0xFF;
+    voices.envAmp[v].noteOff();
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Control Change.
+ * Updates synth parameters based on CC messages, dispatched through ccHandlers.
+ * 
+ * @param channel MIDI channel, selects the voice of the per-voice CCs
+ * @param cc Control Change number
+ * @param value Control value (0-127)
+ */
+void SynthEngine::controlChange(uint8_t channel, uint8_t cc, uint8_t value) {
+  CcHandler handler = ccHandlers[cc & 0x7F];
+  if (handler) {
+    (this->*handler)(voices.forChannel(channel), value & 0x7F);
+  }
+}
+
+void SynthEngine::nrpn(uint8_t channel, uint16_t param, uint16_t value) {
+  const int v = voices.forChannel(channel);
+  const float x = std::min<uint16_t>(value, 16383) * (1.0f / 16383.0f);
+  switch (param) {
+    case 17:
+      voices.voice[v].globalEnvMod = x * 3000.0f;
+      break;
+    case 71: {
+      // (x)^0.8 as in kResonance
+      const float shaped = x > 0.0f ? curves::exp2Fast(0.8f * curves::log2Fast(x)) : 0.0f;
+      smoothed.setTarget(voiceSlot(v, VP_RESONANCE), std::min(shaped, 1.0f));
+      break;
+    }
+    case 74:
+      // 300 Hz * 10^x as in kCutoffHz
+      smoothed.setTarget(voiceSlot(v, VP_CUTOFF), 300.0f * curves::exp2Fast(x * 3.32192809f));
+      break;
+    case 81: {
+      const int minSamples = msToSamples(kDelayMinMs);
+      setFreeDelayTime(minSamples + (int)((int64_t)value * (maxDelaySamples - minSamples) / 16383));
+      break;
+    }
+    default:
+      return;
+  }
+}
+
+void SynthEngine::applyPatch(const Patch& patch) {
+  for (int i = 0; i < Patch::kCcCount; i++) {
+    const uint8_t cc = Patch::kCcs[i];
+    if (cc == 81 || cc == 86 || (cc >= 91 && cc <= 94)) continue;  // Delay timing below
+    CcHandler handler = ccHandlers[cc];
+    if (Patch::isVoiceCc(cc)) {
+      for (int v = 0; v < voices.count; v++) (this->*handler)(v, patch.values[i]);
+    } else {
+      (this->*handler)(0, patch.values[i]);
+    }
+  }
+
+  // Free time on both channels, then the synced ones on their division
+  delayModL = patch.cc(93) % 3;
+  delayModR = patch.cc(94) % 3;
+  delayDivL = curves::delayDivision(patch.cc(91));
+  delayDivR = curves::delayDivision(patch.cc(92));
+  ccDelayTime(0, patch.cc(81));
+  if (patch.delaySync & Patch::SYNC_LEFT) {
+    delaySyncedL = true;
+    delaySyncModL = (patch.delaySync & Patch::STRAIGHT_LEFT) ? 0 : delayModL;
+    delayTimeSamplesL = delayDivisionSamples(delayDivL, delaySyncModL);
+  }
+  if (patch.delaySync & Patch::SYNC_RIGHT) {
+    delaySyncedR = true;
+    delaySyncModR = (patch.delaySync & Patch::STRAIGHT_RIGHT) ? 0 : delayModR;
+    delayTimeSamplesR = delayDivisionSamples(delayDivR, delaySyncModR);
+  }
+  setDelayTimes();
+}
+
+constexpr std::array<SynthEngine::CcHandler, 128> SynthEngine::makeCcTable() {
+  std::array<CcHandler, 128> t{};
+  t[7]   = &SynthEngine::ccVolume;
+  t[14]  = &SynthEngine::ccSubBlend;
+  t[15]  = &SynthEngine::ccAccent;
+  t[16]  = &SynthEngine::ccPitchOffset;
+  t[17]  = &SynthEngine::ccEnvMod;
+  t[18]  = &SynthEngine::ccWaveBlend;
+  t[71]  = &SynthEngine::ccResonance;
+  t[74]  = &SynthEngine::ccCutoff;
+  t[75]  = &SynthEngine::ccDecay;
+  t[77]  = &SynthEngine::ccDistMode;
+  t[78]  = &SynthEngine::ccDistAmount;
+  t[79]  = &SynthEngine::ccDistMix;
+  t[80]  = &SynthEngine::ccDistEnable;
+  t[81]  = &SynthEngine::ccDelayTime;
+  t[82]  = &SynthEngine::ccDelayFeedback;
+  t[83]  = &SynthEngine::ccDelayMix;
+  t[86]  = &SynthEngine::ccDelaySync;
+  t[91]  = &SynthEngine::ccDelayDivL;
+  t[92]  = &SynthEngine::ccDelayDivR;
+  t[93]  = &SynthEngine::ccDelayModL;
+  t[94]  = &SynthEngine::ccDelayModR;
+  t[100] = &SynthEngine::ccGlide;
+  return t;
+}
+
+const std::array<SynthEngine::CcHandler, 128> SynthEngine::ccHandlers = SynthEngine::makeCcTable();
+
+static constexpr float kInv127 = 1.0f / 127.0f;
+
+void SynthEngine::ccVolume(int v, uint8_t value) {
+  // Rescale volume: Max (127) = 0.6 (safe level)
+  float volume = value * (0.6f * kInv127);
+  smoothed.setTarget(SP_VOLUME, volume);
+}
+
+void SynthEngine::ccSubBlend(int v, uint8_t value) {
+  float subAmt = value * kInv127;
+  smoothed.setTarget(voiceSlot(v, VP_SUB_BLEND), subAmt);
+}
+
+void SynthEngine::ccAccent(int v, uint8_t value) {
+  voices.voice[v].accentLevel = value * kInv127; // 0.0 to 1.0
+}
+
+void SynthEngine::ccPitchOffset(int v, uint8_t value) {
+  voices.voice[v].pitchOffset = (value - 64) * (12.0f / 64.0f); // ±12 semitones
+  voices.voice[v].pitchRatio = curves::kPitchRatio[value];
+}
+
+void SynthEngine::ccEnvMod(int v, uint8_t value) {
+  voices.voice[v].globalEnvMod = value * (3000.0f * kInv127);  // reduced to avoid filter instability
+}
+
+void SynthEngine::ccWaveBlend(int v, uint8_t value) {
+  float blendVal = value * kInv127;
+  smoothed.setTarget(voiceSlot(v, VP_WAVE_BLEND), blendVal);
+}
+
+void SynthEngine::ccResonance(int v, uint8_t value) {
+  float shaped = curves::kResonance[value];  // (v/127)^0.8, slightly aggressive but safe shaping
+  smoothed.setTarget(voiceSlot(v, VP_RESONANCE), std::min(shaped, 1.0f));  // ensure cap
+}
+
+void SynthEngine::ccCutoff(int v, uint8_t value) {
+  // Exponential mapping: 300Hz to 3000Hz
+  float freq = curves::kCutoffHz[value];
+  smoothed.setTarget(voiceSlot(v, VP_CUTOFF), freq);
+}
+
+void SynthEngine::ccDecay(int v, uint8_t value) {
+  Voice& vs = voices.voice[v];
+  vs.userDecayTime = 50.0f + value * (1950.0f * kInv127); // 50ms to 2000ms
+  vs.userDecayCoeff = DecayEnvelope::coeffFor(vs.userDecayTime, sampleRate);
+  voices.envFilt[v].setCoeff(vs.userDecayCoeff); // Update immediately
+}
+
+void SynthEngine::ccDistMode(int v, uint8_t value) {
+  distFx.setType(static_cast<Distortion::Type>(value % 5));
+}
+
+void SynthEngine::ccDistAmount(int v, uint8_t value) {
+  float amt = value * kInv127;
+  smoothed.setTarget(SP_DIST_AMOUNT, amt);
+}
+
+void SynthEngine::ccDistMix(int v, uint8_t value) {
+  float mix = value * kInv127;
+  smoothed.setTarget(SP_DIST_MIX, mix);
+}
+
+void SynthEngine::ccDistEnable(int v, uint8_t value) {
+  bool on = value > 63;
+  distFx.setEnabled(on);
+}
+
+void SynthEngine::ccDelayTime(int v, uint8_t value) {
+  const int minSamples = msToSamples(kDelayMinMs);
+  setFreeDelayTime(minSamples + value * (maxDelaySamples - minSamples) / 127);  // ~45 ms to the line length
+}
+
+void SynthEngine::ccDelayFeedback(int v, uint8_t value) {
+  float feedback = value * kInv127;
+  smoothed.setTarget(SP_DELAY_FEEDBACK, feedback);
+}
+
+void SynthEngine::ccDelayMix(int v, uint8_t value) {
+  float mix = value * kInv127;
+  smoothed.setTarget(SP_DELAY_MIX, mix);
+}
+
+void SynthEngine::setFreeDelayTime(int samples) {
+  delayTimeSamplesL = delayTimeSamplesR = samples;
+  delaySyncedL = delaySyncedR = false;
+  setDelayTimes();
+}
+
+void SynthEngine::setDelayTimes() {
+  smoothed.setTarget(SP_DELAY_TIME_L, (float)delayTimeSamplesL);
+  smoothed.setTarget(SP_DELAY_TIME_R, (float)delayTimeSamplesR);
+}
+
+int SynthEngine::delayDivisionSamples(int div, int mod) const {
+  float beats = curves::divisionBeats(div) * curves::kDelayModifier[mod];
+  return std::clamp(beatsToSamples(beats), 1, maxDelaySamples - 1);
+}
+
+void SynthEngine::ccDelaySync(int v, uint8_t value) {
+  // Both channels, straight timing (modifiers apply to CC91-94 only)
+  delayDivL = delayDivR = curves::delayDivision(value);
+  delaySyncedL = delaySyncedR = true;
+  delaySyncModL = delaySyncModR = 0;
+  delayTimeSamplesL = delayDivisionSamples(delayDivL, 0);
+  delayTimeSamplesR = delayTimeSamplesL;
+  setDelayTimes();
+}
+
+void SynthEngine::ccDelayDivL(int v, uint8_t value) {
+  delayDivL = curves::delayDivision(value);
+  delaySyncedL = true;
+  delaySyncModL = delayModL;
+  delayTimeSamplesL = delayDivisionSamples(delayDivL, delayModL);
+  setDelayTimes();
+}
+
+void SynthEngine::ccDelayDivR(int v, uint8_t value) {
+  delayDivR = curves::delayDivision(value);
+  delaySyncedR = true;
+  delaySyncModR = delayModR;
+  delayTimeSamplesR = delayDivisionSamples(delayDivR, delayModR);
+  setDelayTimes();
+}
+
+void SynthEngine::ccDelayModL(int v, uint8_t value) {
+  // Re-time the current division with the new modifier
+  delayModL = value % 3;
+  delaySyncedL = true;
+  delaySyncModL = delayModL;
+  delayTimeSamplesL = delayDivisionSamples(delayDivL, delayModL);
+  setDelayTimes();
+}
+
+void SynthEngine::ccDelayModR(int v, uint8_t value) {
+  delayModR = value % 3;
+  delaySyncedR = true;
+  delaySyncModR = delayModR;
+  delayTimeSamplesR = delayDivisionSamples(delayDivR, delayModR);
+  setDelayTimes();
+}
+
+void SynthEngine::ccGlide(int v, uint8_t value) {
+  voices.voice[v].glideTimeMs = (value == 64) ? 80.0f : value * (500.0f * kInv127);
+}
+
+/**
+ * @brief MIDI Clock tick.
+ * Feeds the tempo fit and re-times the synced delay channels when the tempo moves.
+ * 
+ * @param now micros() timestamp taken when the tick arrived
+ */
+void SynthEngine::clock(uint32_t now) {
+  if (playing) {
+    if (songTicks % 6 == 0) sequencer.clockStep(songTicks / 6);  // Plays from the next render()
+    songTicks++;
+  }
+
+  if (!clockTracker.tick(now)) return;
+  bpm = clockTracker.getBpm();
+  if (sequencer.getSync() == StepSequencer::MIDI_CLOCK) sequencer.setTempo(bpm);  // Gate length
+  if (std::abs(bpm - delaySyncBpm) > kTempoHysteresis * delaySyncBpm) retimeSyncedDelay();
+}
+
+/**
+ * @brief Recomputes the tempo-synced delay times at the current BPM.
+ * They glide there through the delay time smoothers.
+ */
+void SynthEngine::retimeSyncedDelay() {
+  delaySyncBpm = bpm;
+  if (!delaySyncedL && !delaySyncedR) return;
+  if (delaySyncedL) delayTimeSamplesL = delayDivisionSamples(delayDivL, delaySyncModL);
+  if (delaySyncedR) delayTimeSamplesR = delayDivisionSamples(delayDivR, delaySyncModR);
+  setDelayTimes();
+}
+
+void SynthEngine::start() {
+  playing = true;
+  songTicks = 0;
+  clockTracker.restart();
+  stereoDelay.clear();
+}
+
+void SynthEngine::resume() {
+  playing = true;
+}
+
+void SynthEngine::stop() {
+  playing = false;
+  if (sequencer.getSync() == StepSequencer::MIDI_CLOCK) sequencer.releaseNote();
+}
+
+void SynthEngine::songPosition(uint16_t sixteenths) {
+  songTicks = (uint32_t)sixteenths * 6;
+}
+
+void SynthEngine::setSequencerTempo(float newBpm) {
+  sequencer.setTempo(newBpm);
+  if (sequencer.getSync() != StepSequencer::INTERNAL) return;
+  bpm = sequencer.getTempo();
+  if (std::abs(bpm - delaySyncBpm) > kTempoHysteresis * delaySyncBpm) retimeSyncedDelay();
+}
+
+/**
+ * @brief Converts musical beats to sample count based on current BPM.
+ * 
+ * @param beats Number of beats (e.g., 0.25 for 1/16th note)
+ * @return int Number of samples
+ */
+int SynthEngine::beatsToSamples(float beats) const {
+  float seconds = (60.0f / bpm) * beats;
+  return (int)(seconds * sampleRate);
+}
\ No newline at end of file
@@ -0,0 +1,411 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <stdint.h>
+
+#include "VoicePool.h"
+#include "ClockTracker.h"
+#include "StereoDelay.h"
+#include "Distortion.h"
+#include "OutputStage.h"
+#include "ParamSmoother.h"
+#include "FixedPoint.h"
+#include "Patch.h"
+#include "StepSequencer.h"
+
+/**
+ * @file SynthEngine.h
+ * @brief The complete pico-303 voice and effects chain, independent of Arduino.
+ */
+
+/**
+ * @struct AudioConfig
+ * @brief Sample rate and block layout, set once for the engine, KernelBench,
+ * the load statistics and the I2S output.
+ */
+struct AudioConfig {
+  int sampleRate = 44100;  ///< Hz (44100, 48000 or 96000)
+  int blockFrames = 256;   ///< Stereo frames per I2S block
+  int bufferCount = 8;     ///< I2S DMA buffers; latency is bufferCount * blockFrames
+  int maxDelayMs = 1000;   ///< Delay line length (4 bytes per frame with int16 frames)
+};
+
+/**
+ * @class SynthEngine
+ * @brief Owns every DSP object and the synth state, applies note/CC/clock events
+ * and renders interleaved int16 stereo frames.
+ * The firmware drives it from the audio core; the host tools drive it offline.
+ *
+ * Chain: [osc -> filter -> HPF -> VCA] per voice -> mix -> dist -> delay -> soft clip.
+ * Voices play on separate MIDI channels and share the effects; with voice
+ * sharing on, the upper half of the voices can be rendered by the other core.
+ * The hot kernels (osc, filter/HPF/VCA, delay, soft clip) exist as a float and
+ * a fixed-point (Q5.26) set; SYNTH_FIXED_POINT picks the default per
+ * architecture and setKernelSet() switches at runtime (see KernelBench).
+ */
+class SynthEngine {
+public:
+  /**
+   * @brief Processing stages, for per-stage timing.
+   */
+  enum Stage {
+    STAGE_ENV,     ///< Amp and filter envelopes
+    STAGE_OSC,     ///< Oscillator
+    STAGE_FILTER,  ///< Ladder filter and post-filter HPF
+    STAGE_VCA,     ///< VCA mixing, de-clicker and gain
+    STAGE_DIST,    ///< Distortion
+    STAGE_DELAY,   ///< Stereo delay
+    STAGE_OUTPUT,  ///< Soft clip and int16 conversion
+    STAGE_COUNT
+  };
+
+  /**
+   * @brief Implementations of the hot kernels.
+   */
+  enum KernelSet {
+    KERNELS_FLOAT,  ///< Single-precision float (cores with an FPU)
+    KERNELS_FIXED   ///< Q5.26 integer arithmetic (see FixedPoint.h)
+  };
+
+  /// Largest chunk rendered in one pass (render() splits longer requests)
+  static constexpr int kMaxFrames = 256;
+
+  /// Sub-block length while any smoothed parameter is ramping
+  static constexpr int kControlBlock = 32;
+
+  /// Voice slots (SYNTH_MAX_VOICES)
+  static constexpr int kMaxVoices = SYNTH_MAX_VOICES;
+
+  /**
+   * @brief Initializes all DSP objects. Must be called before rendering
+   * (allocates the delay buffers, so not from a global constructor).
+   * Every rate-dependent object (osc, filter, envelopes, HPF, smoothing,
+   * delay) is set up for config.sampleRate; the delay line is sized from
+   * config.maxDelayMs.
+   * @param config Audio configuration
+   * @return true if the delay buffers were allocated
+   */
+  bool begin(const AudioConfig& config);
+
+  /**
+   * @brief Sets the number of active voices (audio core, between renders).
+   * Voice n plays MIDI channels n + 1, n + 1 + count, ... (see VoicePool::forChannel).
+   * @param n Voices [1 ... kMaxVoices]
+   */
+  void setVoiceCount(int n);
+  int getVoiceCount() const { return voices.count; }
+
+  /**
+   * @brief Lets another core render the upper half of the voices.
+   * That core must call runVoiceJob() in its loop; if it does not pick a job up
+   * before the audio core has finished its own half, the audio core renders it.
+   * @param on true to post voice jobs
+   */
+  void setVoiceSharing(bool on) { voiceSharing = on; }
+
+  /**
+   * @brief Renders the posted voice job, if any (called by the helper core).
+   * @return true if a job was rendered
+   */
+  bool runVoiceJob();
+
+  /**
+   * @brief Handles a Note On (Modified-Naive slide/accent logic, per voice).
+   * @param channel MIDI channel (1-16), selects the voice
+   * @param pitch MIDI note number (0-127)
+   * @param velocity Note velocity (0-127, >= 100 is accented)
+   */
+  void noteOn(uint8_t channel, uint8_t pitch, uint8_t velocity);
+
+  /**
+   * @brief Handles a Note Off.
+   * @param channel MIDI channel, selects the voice
+   * @param pitch MIDI note number
+   * @param velocity Release velocity
+   * @return true if the note was released (no overlapping note is still held)
+   */
+  bool noteOff(uint8_t channel, uint8_t pitch, uint8_t velocity);
+
+  /**
+   * @brief Handles a Control Change (see README for the CC map).
+   * Voice CCs (sound and envelope) go to the channel's voice, effect and volume
+   * CCs are shared.
+   * @param channel MIDI channel
+   * @param cc Control Change number
+   * @param value Control value (0-127)
+   */
+  void controlChange(uint8_t channel, uint8_t cc, uint8_t value);
+
+  /**
+   * @brief Handles a 14-bit NRPN for the controls that need finer steps than
+   * a CC: cutoff (74), resonance (71), env mod (17) and delay time (81).
+   * The parameter number is the CC number (NRPN MSB 0); the value covers the
+   * CC's range with 128 times the resolution. Other parameters are ignored.
+   * @param channel MIDI channel
+   * @param param NRPN parameter number
+   * @param value Data entry value (0-16383)
+   */
+  void nrpn(uint8_t channel, uint16_t param, uint16_t value);
+
+  /// True for the NRPN parameters nrpn() handles
+  static bool hasNrpn(uint16_t param) { return param == 17 || param == 71 || param == 74 || param == 81; }
+
+  /**
+   * @brief Applies a whole patch at once, between two rendered chunks.
+   * The smoothed destinations ramp to their new values together; the voice
+   * CCs go to every voice.
+   * @param patch Sound settings to apply
+   */
+  void applyPatch(const Patch& patch);
+
+  /**
+   * @brief Handles a MIDI Clock tick (24 ppqn).
+   * The tempo comes from a ClockTracker fit; when it moves by more than
+   * kTempoHysteresis, tempo-synced delay channels are re-timed (gliding).
+   * @param now Tick arrival time in microseconds
+   */
+  void clock(uint32_t now);
+
+  /**
+   * @brief MIDI Start: rewinds the song position and clears the delay line,
+   * so no echo from before the downbeat plays into the song.
+   */
+  void start();
+
+  /**
+   * @brief MIDI Continue: resumes counting ticks from the current song position.
+   */
+  void resume();
+
+  /**
+   * @brief MIDI Stop: holds the song position (the delay tail rings out).
+   */
+  void stop();
+
+  /**
+   * @brief MIDI Song Position Pointer.
+   * @param sixteenths Position in 16th notes (6 ticks each)
+   */
+  void songPosition(uint16_t sixteenths);
+
+  /**
+   * @brief Replaces the step sequencer's pattern (audio core only).
+   * A running sequence continues at its step index.
+   */
+  void setPattern(const StepSequencer::Pattern& p) { sequencer.setPattern(p); }
+
+  /**
+   * @brief Selects the sequencer clock: its own tempo or the MIDI clock
+   * (steps on every 6th tick while the transport plays).
+   */
+  void setSequencerSync(StepSequencer::Sync s) { sequencer.setSync(s); }
+
+  /**
+   * @brief Sets the sequencer tempo. With INTERNAL sync it is also the tempo
+   * the synced delay follows, until a MIDI clock arrives.
+   * @param bpm Beats per minute (20-300)
+   */
+  void setSequencerTempo(float bpm);
+
+  /// Starts the step sequencer at step 0 (with MIDI_CLOCK sync, on the next step tick)
+  void startSequencer() { sequencer.start(); }
+  /// Stops the step sequencer and releases its note
+  void stopSequencer() { sequencer.stop(); }
+
+  const StepSequencer& getSequencer() const { return sequencer; }
+
+  bool isPlaying() const { return playing; }
+  /// Ticks (24 ppqn) since the start of the song
+  uint32_t getSongTicks() const { return songTicks; }
+
+  /**
+   * @brief Renders stereo frames.
+   * @param out Interleaved L/R output, 4-byte aligned (2 * frames values)
+   * @param frames Number of stereo frames
+   */
+  void render(int16_t* out, int frames);
+
+  /**
+   * @brief Sets the clock used for per-stage timing (nullptr disables it).
+   * @param clk Returns a free-running tick count (cycles, ns, ...)
+   */
+  void setProfileClock(uint32_t (*clk)()) { profileClock = clk; }
+
+  /**
+   * @brief Accumulated ticks per Stage since the last resetStageTicks().
+   */
+  const uint32_t* getStageTicks() const { return stageTicks; }
+
+  /**
+   * @brief Clears the per-stage tick counters.
+   */
+  void resetStageTicks();
+
+  /**
+   * @brief Selects the kernel set used from the next chunk on (audio core only).
+   * @param k Kernel set
+   */
+  void setKernelSet(KernelSet k) { kernelSet = k; }
+  KernelSet getKernelSet() const { return kernelSet; }
+
+  /**
+   * @brief Selects the oscillators' band-limiting method (audio core only).
+   * @param m Oscillator::POLYBLEP or Oscillator::WAVETABLE
+   */
+  void setOscMethod(Oscillator::Method m) {
+    for (int v = 0; v < kMaxVoices; v++) voices.osc[v].setMethod(m);
+  }
+  Oscillator::Method getOscMethod() const { return voices.osc[0].getMethod(); }
+
+  float getBpm() const { return bpm; }
+  int getSampleRate() const { return sampleRate; }
+  const AudioConfig& getConfig() const { return config; }
+
+private:
+  void renderChunk(int16_t* out, int n);
+  int runSequencer();
+  uint32_t renderVoices(int first, int last, int n, uint32_t t, bool timed);
+  void applySmoothed();
+  int beatsToSamples(float beats) const;
+  int msToSamples(float ms) const { return (int)(ms * sampleRate / 1000.0f); }
+
+  // CC handlers, one table slot per CC number (nullptr = not mapped)
+  using CcHandler = void (SynthEngine::*)(int v, uint8_t value);
+  static constexpr std::array<CcHandler, 128> makeCcTable();
+  static const std::array<CcHandler, 128> ccHandlers;
+
+  void ccVolume(int v, uint8_t value);
+  void ccSubBlend(int v, uint8_t value);
+  void ccAccent(int v, uint8_t value);
+  void ccPitchOffset(int v, uint8_t value);
+  void ccEnvMod(int v, uint8_t value);
+  void ccWaveBlend(int v, uint8_t value);
+  void ccResonance(int v, uint8_t value);
+  void ccCutoff(int v, uint8_t value);
+  void ccDecay(int v, uint8_t value);
+  void ccDistMode(int v, uint8_t value);
+  void ccDistAmount(int v, uint8_t value);
+  void ccDistMix(int v, uint8_t value);
+  void ccDistEnable(int v, uint8_t value);
+  void ccDelayTime(int v, uint8_t value);
+  void ccDelayFeedback(int v, uint8_t value);
+  void ccDelayMix(int v, uint8_t value);
+  void ccDelaySync(int v, uint8_t value);
+  void ccDelayDivL(int v, uint8_t value);
+  void ccDelayDivR(int v, uint8_t value);
+  void ccDelayModL(int v, uint8_t value);
+  void ccDelayModR(int v, uint8_t value);
+  void ccGlide(int v, uint8_t value);
+  void setDelayTimes();
+  void setFreeDelayTime(int samples);
+  void retimeSyncedDelay();
+
+  // Delay time for a sync division with the channel's rhythm modifier applied
+  int delayDivisionSamples(int div, int mod) const;
+
+  // Adds the time since t0 to a stage and returns the new timestamp
+  inline uint32_t markStage(Stage s, uint32_t t0) {
+    if (!profileClock) return 0;
+    uint32_t t1 = profileClock();
+    stageTicks[s] += t1 - t0;
+    return t1;
+  }
+
+  AudioConfig config;
+  int sampleRate = 44100;
+
+  // Per-voice chain and note state
+  VoicePool<kMaxVoices, kMaxFrames> voices;
+
+  // Envelope factors of the note-on path, computed in begin() (the user
+  // decay is cached per voice at CC75), so a note runs no exp()
+  static constexpr float kAccentDecayMs = 200.0f;   // Filter env decay of accented notes
+  static constexpr float kReleaseMs = 10.0f;        // Amp env release
+  static constexpr float kAccentReleaseMs = 50.0f;  // Amp env release of accented notes
+  float accentDecayCoeff = 0.0f;
+  float releaseCoeff = 0.0f;
+  float accentReleaseCoeff = 0.0f;
+
+  // Shared effects and output
+  Distortion distFx;
+  StereoDelay stereoDelay;
+  OutputStage outputStage;
+
+  // Smoothed CC destinations (slots in `smoothed`): the shared ones, then
+  // VP_COUNT slots per voice
+  enum SmoothedParam {
+    SP_VOLUME,
+    SP_DIST_AMOUNT,
+    SP_DIST_MIX,
+    SP_DELAY_FEEDBACK,
+    SP_DELAY_MIX,
+    SP_DELAY_TIME_L,
+    SP_DELAY_TIME_R,
+    SP_VOICE_BASE
+  };
+  enum VoiceParam {
+    VP_SUB_BLEND,
+    VP_WAVE_BLEND,
+    VP_CUTOFF,
+    VP_RESONANCE,
+    VP_COUNT
+  };
+  static_assert(SP_VOICE_BASE + kMaxVoices * VP_COUNT <= ParamSmoother::kMaxParams,
+                "Not enough smoother slots for SYNTH_MAX_VOICES");
+  static constexpr int voiceSlot(int v, VoiceParam p) { return SP_VOICE_BASE + v * VP_COUNT + p; }
+  ParamSmoother smoothed;
+
+  // MIDI clock and transport state
+  static constexpr float kTempoHysteresis = 0.002f;  // Relative tempo change that re-times the delay
+  ClockTracker clockTracker;
+  float bpm = 120.0f;
+  float delaySyncBpm = 120.0f;  // Tempo the synced delay times were computed at
+  bool playing = false;
+  uint32_t songTicks = 0;
+
+  // On-board sequencer, stepped between render chunks
+  StepSequencer sequencer;
+
+  // ---- Delay state ----
+  static constexpr float kDelayDefaultMs = 250.0f;
+  static constexpr float kDelayMinMs = 45.3515f;  // Shortest CC81 time (2000 samples at 44.1 kHz)
+  int maxDelaySamples = 44100;  // Line length (config.maxDelayMs)
+  int delayTimeSamplesL = 11025;
+  int delayTimeSamplesR = 11025;
+
+  // Delay sync divisions (index into 1/16, 1/8, 1/4 ... beats, see ControlCurves.h)
+  int delayDivL = 2;
+  int delayDivR = 2;
+
+  // Delay modifiers: 0 = Full, 1 = Dotted, 2 = Triplet
+  int delayModL = 0;
+  int delayModR = 0;
+
+  // Tempo-synced channels (CC86/91-94; CC81 sets a free time) and the
+  // modifier their time uses (CC86 times straight)
+  bool delaySyncedL = false;
+  bool delaySyncedR = false;
+  int delaySyncModL = 0;
+  int delaySyncModR = 0;
+
+  // Scratch buffers for the shared part of the chain (one chunk at a time)
+  float outBufL[kMaxFrames];
+  float outBufR[kMaxFrames];
+  // Q5.26 buffers of the fixed-point kernels
+  int32_t outQL[kMaxFrames];
+  int32_t outQR[kMaxFrames];
+
+  // Voice job for the helper core: voices [jobFirst, jobLast) of a jobFrames chunk
+  enum JobState : uint32_t { JOB_IDLE, JOB_POSTED, JOB_CLAIMED, JOB_DONE };
+  bool voiceSharing = false;
+  int jobFirst = 0;
+  int jobLast = 0;
+  int jobFrames = 0;
+  std::atomic<uint32_t> jobState{JOB_IDLE};
+
+  KernelSet kernelSet = SYNTH_FIXED_POINT ? KERNELS_FIXED : KERNELS_FLOAT;
+
+  // Per-stage timing
+  uint32_t (*profileClock)() = nullptr;
+  uint32_t stageTicks[STAGE_COUNT] = {};
+};
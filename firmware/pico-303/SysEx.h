@@ -0,0 +1,57 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @file SysEx.h
+ * @brief pico-303 System Exclusive message IDs and 7-bit packing helpers.
+ *
+ * Every message is F0 7D <command> [payload...] F7. 0x7D is the MIDI
+ * "non-commercial" manufacturer ID. 32-bit values are sent as five 7-bit
+ * bytes, least significant first.
+ */
+
+#define SYSEX_MANUFACTURER_ID 0x7D
+
+enum SysExCommand : uint8_t {
+  SYSEX_STATS_REQUEST = 0x01, ///< Host -> synth: query audio statistics
+  SYSEX_STATS_REPLY   = 0x02, ///< Synth -> host: statistics (see handleSysEx)
+  SYSEX_STATS_RESET   = 0x03, ///< Host -> synth: clear peak load / buffer figures
+  SYSEX_PRESET_RECALL = 0x04, ///< Host -> synth: <slot> load a preset (as Program Change)
+  SYSEX_PRESET_STORE  = 0x05, ///< Host -> synth: <slot> save the current sound to a preset
+  SYSEX_PATCH_REQUEST = 0x06, ///< Host -> synth: request a patch dump
+  SYSEX_PATCH_DUMP    = 0x07, ///< Both ways: <delay sync> <count> (<cc> <value>) x count
+  SYSEX_STATS_PUSH    = 0x08, ///< Host -> synth: <interval> send a stats reply every interval * 100 ms (0 = off)
+  SYSEX_PATTERN_LOAD  = 0x09, ///< Host -> synth: <length> <channel> (<pitch> <flags>) x 16 sequencer pattern
+  SYSEX_SEQUENCER     = 0x0A, ///< Host -> synth: <SynthEvent::SeqCommand> [<value MSB> <value LSB>]
+  SYSEX_LATENCY_REQUEST = 0x0B, ///< Host -> synth: query the latency histograms (LATENCY_PROBE builds)
+  SYSEX_LATENCY_REPLY   = 0x0C  ///< Synth -> host: latency histograms (see sendLatencyReport)
+};
+
+/// Bytes used by one packed 32-bit value
+#define SYSEX_U32_BYTES 5
+
+/**
+ * @brief Packs a 32-bit value into five 7-bit bytes.
+ * @param p Destination (SYSEX_U32_BYTES bytes)
+ * @param v Value to pack
+ * @return Pointer past the written bytes
+ */
+static inline uint8_t* sysexPackU32(uint8_t* p, uint32_t v) {
+  for (int i = 0; i < SYSEX_U32_BYTES; i++) {
+    *p++ = v & 0x7F;
+    v >>= 7;
+  }
+  return p;
+}
+
+/**
+ * @brief Unpacks a value written by sysexPackU32().
+ * @param p Source (SYSEX_U32_BYTES bytes)
+ */
+static inline uint32_t sysexUnpackU32(const uint8_t* p) {
+  uint32_t v = 0;
+  for (int i = SYSEX_U32_BYTES - 1; i >= 0; i--) {
+    v = (v << 7) | (p[i] & 0x7F);
+  }
+  return v;
+}
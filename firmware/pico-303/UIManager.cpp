@@ -4,6 +4,7 @@
  */
 
 #include "UIManager.h"
+#include <string.h>
 
 // Quadrature decoding lookup table
 // [previous state][current state] -> delta (-1, 0, +1)
@@ -57,6 +58,10 @@ UIManager::UIManager()
   , lastButtonTime(0)
   , parameterCallback(nullptr)
 {
+  memset(ccToParam, kNoParameter, sizeof(ccToParam));
+  for (uint8_t i = 0; i < paramCount; i++) {
+    ccToParam[parameters[i].cc & 0x7F] = i;
+  }
 }
 
 void UIManager::begin(uint8_t pinA, uint8_t pinB, uint8_t pinSW) {
@@ -219,12 +224,11 @@ const Parameter& UIManager::getParameter(uint8_t index) const {
   return parameters[index];
 }
 
-void UIManager::updateParameterValue(uint8_t cc, uint8_t value) {
-  // Find parameter by CC number and update its value
-  for (uint8_t i = 0; i < paramCount; i++) {
-    if (parameters[i].cc == cc) {
-      parameters[i].value = value;
-      break;
-    }
+bool UIManager::updateParameterValue(uint8_t cc, uint8_t value) {
+  uint8_t index = ccToParam[cc & 0x7F];
+  if (index == kNoParameter || parameters[index].value == value) {
+    return false;
   }
+  parameters[index].value = value;
+  return index == currentParamIndex;
 }
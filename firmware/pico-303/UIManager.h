@@ -78,8 +78,9 @@ public:
    * @brief Update parameter value from external source (e.g., MIDI CC)
    * @param cc Control change number
    * @param value New value (0-127)
+   * @return true if the parameter on screen changed (needs a redraw)
    */
-  void updateParameterValue(uint8_t cc, uint8_t value);
+  bool updateParameterValue(uint8_t cc, uint8_t value);
   
   /**
    * @brief Set callback for parameter changes
@@ -113,6 +114,10 @@ private:
   // Parameters array
   static Parameter parameters[];
   static const uint8_t paramCount;
+
+  // CC number -> index into parameters[] (kNoParameter if the CC has no entry)
+  static const uint8_t kNoParameter = 0xFF;
+  uint8_t ccToParam[128];
   
   // Callback for parameter changes
   void (*parameterCallback)(uint8_t cc, uint8_t value);
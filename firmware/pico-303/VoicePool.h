@@ -0,0 +1,125 @@
+#pragma once
+#include <stdint.h>
+
+#include "Oscillator.h"
+#include "Filter303.h"
+#include "DecayEnvelope.h"
+#include "AnalogEnvelope.h"
+#include "LeakyIntegrator.h"
+#include "DCBlocker.h"
+
+/**
+ * @file VoicePool.h
+ * @brief Per-voice state of the SynthEngine, stored as struct-of-arrays.
+ */
+
+// Voice slots compiled in (about 5 KB of block buffers per slot)
+#ifndef SYNTH_MAX_VOICES
+#define SYNTH_MAX_VOICES 4
+#endif
+
+// 1 = skip released voices once they are silent. Their osc and filter state
+// freezes until the next note, so its first milliseconds differ slightly from
+// a voice that kept running. 0 = always render every voice.
+#ifndef SYNTH_IDLE_BYPASS
+#define SYNTH_IDLE_BYPASS 1
+#endif
+
+/**
+ * @struct Voice
+ * @brief MIDI-side state of one voice: the Modified-Naive slide/accent logic
+ * and the sound settings of its channel.
+ */
+struct Voice {
+  // MIDI state (Modified‑Naive)
+  uint8_t prevNote = 0xFF;
+  uint8_t noteOverlap = 0;
+  bool lastNoteWasAccented = false;
+
+  float accentLevel = 0.5f;         // 0.0 to 1.0 (controlled by CC15)
+  float currentAccentGain = 0.0f;   // Actual gain applied to current note
+  float pitchOffset = 0.0f;         // in semitones
+  float pitchRatio = 1.0f;          // 2^(pitchOffset / 12)
+  float globalEnvMod = 2000.0f;
+  float glideTimeMs = 80.0f;        // default TB-303 glide time
+  float userDecayTime = 1000.0f;    // decay time setting
+  float userDecayCoeff = 0.0f;      // Filter env factor for userDecayTime (cached at CC75)
+};
+
+/**
+ * @struct VoicePool
+ * @brief The per-voice chain (envelopes, osc -> filter -> HPF -> VCA) of up
+ * to MaxVoices voices. Every member holds one entry per voice, so the engine
+ * runs each stage over all voices in one pass (the stage's code stays in the
+ * XIP cache) and can hand a contiguous range of voices to the other core.
+ * @tparam MaxVoices Voice slots
+ * @tparam MaxFrames Largest chunk
+ */
+template <int MaxVoices, int MaxFrames>
+struct VoicePool {
+  static constexpr int kMaxVoices = MaxVoices;
+  int count = 1;  // Active voices
+  int settleFrames = 882;  // Quiet frames before a voice is silent, 10 de-click time constants (20 ms)
+
+  bool silent[MaxVoices] = {};  // Skipped this chunk: output is exactly 0
+  int quietFrames[MaxVoices] = {};  // Frames rendered since the amp envelope finished
+
+  Voice voice[MaxVoices];
+
+  // Audio Objects
+  Oscillator osc[MaxVoices];
+  Filter303 filter[MaxVoices];
+  DCBlocker hpfPostFilter[MaxVoices];
+
+  // Open303 Envelopes
+  DecayEnvelope envFilt[MaxVoices];          // Filter Envelope (was mainEnv)
+  AnalogEnvelope envAmp[MaxVoices];          // Amp Envelope (was ampEnv)
+  LeakyIntegrator accentSmoother[MaxVoices]; // rc2 in Open303
+  LeakyIntegrator ampDeClicker[MaxVoices];   // Smoothes VCA signal to prevent clicks
+
+  // Block buffers (one chunk at a time)
+  float out[MaxVoices][MaxFrames];           // Voice output, float kernels
+  float envAmpBuf[MaxVoices][MaxFrames];
+  float envFiltBuf[MaxVoices][MaxFrames];
+  int32_t outQ[MaxVoices][MaxFrames];        // Voice output, fixed-point kernels (Q5.26)
+  int32_t ampQ[MaxVoices][MaxFrames];
+
+  /**
+   * @brief Voice that plays a MIDI channel: channels 1, 2, ... cycle over the
+   * active voices, so a single voice answers on every channel.
+   * @param channel MIDI channel (1-16)
+   */
+  int forChannel(uint8_t channel) const { return channel ? (channel - 1) % count : 0; }
+
+  /**
+   * @brief Refreshes silent[] for the next chunk. A voice goes silent once its
+   * note is released and its amp envelope has been finished for settleFrames.
+   * The envelope finishes below 1e-4 (-80 dB), where the VCA de-clicker lags
+   * it by at most 1.25x (2 ms behind the 10 ms release). The 10 de-click time
+   * constants of settleFrames take that another e^-10 (-87 dB) down, so the
+   * gain cut off is below -160 dB in total. It stays silent, with osc,
+   * filter and filter env frozen, until the next Note On. The timing only
+   * depends on the (float) envelope, so both kernel sets freeze on the same chunk.
+   * @param n Frames in the next chunk
+   * @return Number of sounding voices
+   */
+  int updateSilence(int n) {
+    int sounding = 0;
+    for (int v = 0; v < count; v++) {
+#if SYNTH_IDLE_BYPASS
+      if (voice[v].prevNote == 0xFF && envAmp[v].isIdle()) {
+        if (!silent[v] && quietFrames[v] >= settleFrames) {
+          silent[v] = true;
+          ampDeClicker[v].reset();
+        }
+        if (quietFrames[v] < settleFrames) quietFrames[v] += n;
+      } else {
+        silent[v] = false;
+        quietFrames[v] = 0;
+      }
+#endif
+      if (!silent[v]) sounding++;
+    }
+    return sounding;
+  }
+};
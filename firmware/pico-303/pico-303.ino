@@ -2,8 +2,9 @@
  * @file pico-303.ino
  * @brief Main firmware file for the pico-303 synthesizer.
  * 
- * This file handles the main setup, audio processing loop, MIDI event handling,
- * and integration of various synthesis components (Oscillator, Filter, Envelopes, Effects).
+ * This file handles the main setup, the dual-core audio/control loops and MIDI
+ * event handling. The synthesis chain itself (Oscillator, Filter, Envelopes,
+ * Effects) lives in SynthEngine so it can also be rendered off the board.
  */
 
 // =============================================================================
@@ -11,6 +12,24 @@
 // =============================================================================
 // Uncomment the following line to enable the OLED Display and Rotary Encoder UI
 #define ENABLE_UI
+// Uncomment to show the audio core load and underrun count on the menu screen
+// #define SHOW_AUDIO_LOAD
+// Uncomment to switch to the faster kernel set measured at startup (KernelBench);
+// otherwise the set is picked per architecture (float on Arm, fixed point on RISC-V)
+// #define KERNEL_AUTOSELECT
+// Uncomment to render straight into the I2S DMA buffers (I2SRing) instead of
+// copying each block into the I2S library; rendering is then started by the DMA
+// interrupt, and fewer buffers (lower latency) are enough
+// #define I2S_ZERO_COPY
+// Voices, one per MIDI channel from channel 1 (up to SYNTH_MAX_VOICES). With
+// more than one, core 0 renders the upper half of the voices between MIDI/UI work.
+#define VOICE_COUNT 1
+// SYNTH_RAM_FUNCS=1 (build flag, see HotPath.h) runs the render path from SRAM
+// instead of XIP flash, so UI/USB code cannot evict it from the flash cache
+// Uncomment to measure the note-on to DAC latency (LatencyProbe, SysEx 0x0B);
+// with I2S_ZERO_COPY, LATENCY_PULSE_PIN also pulses when each measured note's
+// first sample is played
+// #define LATENCY_PROBE
 
 #include <algorithm>
 #include <Arduino.h>
@@ -19,34 +38,70 @@
 #include <I2S.h>
 #include <AudioBufferManager.h>
 #include <cmath>
-#include <pico/mutex.h>
-
-#include "Oscillator.h"
-#include "Filter303.h"
-#include "StereoDelay.h"
-#include "DecayEnvelope.h"
-#include "AnalogEnvelope.h"
-#include "LeakyIntegrator.h"
-#include "Distortion.h"
-#include "DCBlocker.h"
+
+#include "Debug.h"
+#include "EventQueue.h"
+#include "SynthEngine.h"
+#include "HotPath.h"
+#include "AudioMonitor.h"
+#include "KernelBench.h"
+#include "EffectArena.h"
+#include "I2SRing.h"
+#include "SysEx.h"
+#include "Patch.h"
+#include "PresetStore.h"
+#include "CcCoalescer.h"
+#include "LatencyProbe.h"
 #ifdef ENABLE_UI
 #include "UIManager.h"
 #include "DisplayManager.h"
 #endif
 
-// =============================================================================
-// Debug Configuration
-// =============================================================================
-#define DEBUG_SERIAL false // Set to false to disable Serial output
-
-#if DEBUG_SERIAL
-  #define DEBUG_PRINTF(...) Serial.printf(__VA_ARGS__)
-  #define DEBUG_PRINTLN(...) Serial.println(__VA_ARGS__)
-  #define DEBUG_BEGIN(...) Serial.begin(__VA_ARGS__)
+// Sample rate (44100, 48000 or 96000), audio block size in stereo frames and
+// number of I2S DMA buffers. They seed audioConfig, which sets up the engine, the
+// load statistics and I2S. Output latency is roughly
+// I2S_BUFFER_COUNT * AUDIO_BLOCK_SIZE / AUDIO_SAMPLE_RATE;
+// smaller values lower latency at the cost of CPU headroom (per-block overhead)
+// and underrun margin. Override from the build flags to tune per deployment.
+#ifndef AUDIO_SAMPLE_RATE
+#define AUDIO_SAMPLE_RATE 44100
+#endif
+#ifndef AUDIO_BLOCK_SIZE
+#define AUDIO_BLOCK_SIZE 256
+#endif
+#ifndef I2S_BUFFER_COUNT
+#ifdef I2S_ZERO_COPY
+#define I2S_BUFFER_COUNT 4
+#else
+#define I2S_BUFFER_COUNT 8
+#endif
+#endif
+// Delay line length. 1 s takes 4 bytes per frame: 172 KB at 44.1 kHz, 375 KB at 96 kHz
+#ifndef AUDIO_MAX_DELAY_MS
+#if AUDIO_SAMPLE_RATE > 48000
+#define AUDIO_MAX_DELAY_MS 500
 #else
-  #define DEBUG_PRINTF(...)
-  #define DEBUG_PRINTLN(...)
-  #define DEBUG_BEGIN(...)
+#define AUDIO_MAX_DELAY_MS 1000
+#endif
+#endif
+// On boards with PSRAM (RP2350_PSRAM_CS) the delay line moves into an
+// EFFECT_PSRAM_KB arena there and is AUDIO_PSRAM_DELAY_MS long (1.5 MB at 96 kHz)
+#ifndef AUDIO_PSRAM_DELAY_MS
+#define AUDIO_PSRAM_DELAY_MS 4000
+#endif
+#ifndef EFFECT_PSRAM_KB
+#define EFFECT_PSRAM_KB 2048
+#endif
+// Latency histogram bin widths in µs (32 bins each) and the serial report
+// interval of DEBUG_SERIAL builds
+#ifndef LATENCY_BIN_US
+#define LATENCY_BIN_US 2000
+#endif
+#ifndef JITTER_BIN_US
+#define JITTER_BIN_US 100
+#endif
+#ifndef LATENCY_REPORT_MS
+#define LATENCY_REPORT_MS 10000
 #endif
 
 // =============================================================================
@@ -60,6 +115,9 @@
 // LED pin
 #define LED_PIN 25
 
+// Latency marker pin (LATENCY_PROBE with I2S_ZERO_COPY), for a scope next to the DAC output
+// #define LATENCY_PULSE_PIN 15
+
 // UI Pins (OLED & Encoder)
 #ifdef ENABLE_UI
   #define DISPLAY_I2C_SDA  2
@@ -68,166 +126,360 @@
   #define ENCODER_A_PIN    6
   #define ENCODER_B_PIN    7
   #define ENCODER_SW_PIN   8
+
+  // Minimum time between screen redraws (only changed bytes go over I2C)
+  #define DISPLAY_REFRESH_MS 30
+
+  // Encoder edits are coalesced per CC: applied at most every CC_APPLY_INTERVAL_US
+  // and echoed over USB MIDI at most every CC_ECHO_INTERVAL_US
+  #define CC_APPLY_INTERVAL_US 1000
+  #define CC_ECHO_INTERVAL_US  10000
 #endif
 
 // =============================================================================
 // Globals & Objects
 // =============================================================================
 
+#ifdef I2S_ZERO_COPY
+I2SRing i2sOut;
+#else
 I2S i2sOut(OUTPUT, pBCLK, pDOUT);
+#endif
 
-// Audio Objects
-Oscillator osc;
-Filter303 filter;
-StereoDelay delayFx;
-Distortion distFx;
-DCBlocker hpfPostFilter;
+// Voice and effects chain (owned by core 1)
+SynthEngine engine;
 
-// Synthesis objects
+// Load/underrun statistics (written by core 1, read by core 0)
+AudioMonitor audioMonitor;
+
+#ifdef LATENCY_PROBE
+// Note-on latency histograms (written by core 1, read by core 0)
+LatencyProbe latencyProbe(LATENCY_BIN_US, JITTER_BIN_US);
+#endif
+
+// UI objects (owned by core 0)
 #ifdef ENABLE_UI
 UIManager uiManager;
 DisplayManager displayManager;
+CcCoalescer ccApply(CC_APPLY_INTERVAL_US);
+CcCoalescer ccEcho(CC_ECHO_INTERVAL_US);
 #endif
 
-// Open303 Envelopes & Voice State
-DecayEnvelope envFilt;      // Filter Envelope (was mainEnv)
-AnalogEnvelope envAmp;      // Amp Envelope (was ampEnv)
-LeakyIntegrator accentSmoother; // rc2 in Open303
-LeakyIntegrator ampDeClicker;   // Smoothes VCA signal to prevent clicks
-
-float accentLevel = 0.5f; // 0.0 to 1.0 (controlled by CC15)
-float currentAccentGain = 0.0f; // Actual gain applied to current note
-float envMod = 0.5f;  // 0..1
-float accent = 0.5f;  // 0..1
+// Preset slots in flash and the current sound (owned by core 0)
+PresetStore presetStore;
+Patch livePatch;
 
-// Audio Buffer
-const int sampleRate = 44100;
+// Audio configuration (read by the audio core in setup1)
+AudioConfig audioConfig = { AUDIO_SAMPLE_RATE, AUDIO_BLOCK_SIZE, I2S_BUFFER_COUNT, AUDIO_MAX_DELAY_MS };
 
 // MIDI
 Adafruit_USBD_MIDI usb_midi;
 MIDI_CREATE_INSTANCE(Adafruit_USBD_MIDI, usb_midi, MIDI);
 
-// LED
-uint32_t ledOnUntil = 20;
+// LED (written by the audio core, cleared by the control core)
+volatile uint32_t ledOnUntil = 20;
 
-volatile uint32_t clockTickCount = 0;
-uint32_t lastClockMicros = 0;
-float bpm = 120.0f;
+// Flag to trigger display update when MIDI CC changes a parameter
+#ifdef ENABLE_UI
+volatile bool midiNeedsDisplayUpdate = false;
+#endif
 
-// MIDI state (Modified‑Naive)
-uint8_t prev_note = 0xFF;
-uint8_t noteOverlap = 0;
+// ---- Core Handoff ----
+// Core 0 owns USB MIDI, the encoder and the OLED. Core 1 owns every DSP object
+// and the I2S output. Note, CC and clock events are never applied from core 0;
+// they are posted to this lock-free ring (core 0 = sole producer, core 1 = sole
+// consumer) and applied by core 1 inside fillAudioBlock().
+#define EVENT_QUEUE_LENGTH 256
+EventQueue<SynthEvent, EVENT_QUEUE_LENGTH> eventQueue;
 
-// Synth state
-float volume = 0.6f;
-bool lastNoteWasAccented = false;
-float pitchOffset = 0.0f;         // in semitones
-float globalEnvMod = 2000.0f;
-float glideTimeMs = 80.0f;        // default TB-303 glide time
-float userDecayTime = 1000.0f;    // decay time setting
+// Recalled presets, handed over whole so core 1 swaps the sound in one step;
+// a PATCH event in eventQueue marks where each one applies
+EventQueue<Patch, 4> patchQueue;
 
-// ---- Delay globals ----
-const int maxDelaySamples = 44100;  // 1 second delay max
-int delayTimeSamplesL = 22050;
-int delayTimeSamplesR = 22050;
-float delayFeedback = 0.5f;
-float delayMix = 0.3f;
+// Sequencer patterns from SysEx, handed over the same way (PATTERN events)
+EventQueue<StepSequencer::Pattern, 2> patternQueue;
 
-// Delay modifiers: 0 = Full, 1 = Dotted, 2 = Triplet
-int delayModL = 0;
-int delayModR = 0;
+// Interval of the statistics push in ms, 0 = off (core 0)
+uint32_t statsPushMs = 0;
 
-StereoDelay stereoDelay;
+// Set by core 0 once MIDI is configured, so core 1 does not start early
+volatile bool controlCoreReady = false;
 
-// Flag to trigger display update when MIDI CC changes a parameter
+/**
+ * @brief Posts a timestamped event from core 0 to the audio core.
+ * Waits (at most one audio block) if the ring is full, so changes are never dropped.
+ */
+void postEvent(uint8_t type, uint8_t channel, uint8_t data1, uint8_t data2) {
+  pushEvent({ micros(), type, channel, data1, data2, 0 });
+}
+
+/**
+ * @brief Queues a complete event, waiting while the ring is full (core 0).
+ */
+void pushEvent(const SynthEvent& ev) {
+  while (!eventQueue.push(ev)) {
+    tight_loop_contents();
+  }
+}
+
+/**
+ * @brief Lights the activity LED for 20ms (cleared in loop()).
+ */
+void blinkLed() {
+  digitalWrite(LED_PIN, HIGH);
+  ledOnUntil = millis() + 20;
+}
+
+/**
+ * @brief Applies a single queued event on the audio core.
+ */
+void applyEvent(const SynthEvent& ev) {
+  switch (ev.type) {
+    case SynthEvent::NOTE_ON:
+      engine.noteOn(ev.channel, ev.data1, ev.data2);
+      blinkLed();
+      break;
+    case SynthEvent::NOTE_OFF:
+      if (engine.noteOff(ev.channel, ev.data1, ev.data2)) blinkLed();
+      break;
+    case SynthEvent::CONTROL_CHANGE:
+      engine.controlChange(ev.channel, ev.data1, ev.data2);
+      break;
+    case SynthEvent::CLOCK:
+      engine.clock(ev.timestamp);
+      break;
+    case SynthEvent::START:
+      engine.start();
+      break;
+    case SynthEvent::CONTINUE:
+      engine.resume();
+      break;
+    case SynthEvent::STOP:
+      engine.stop();
+      break;
+    case SynthEvent::SONG_POSITION:
+      engine.songPosition(ev.data1 | (ev.data2 << 7));
+      break;
+    case SynthEvent::PATCH: {
+      Patch patch;
+      if (patchQueue.pop(patch)) engine.applyPatch(patch);
+      break;
+    }
+    case SynthEvent::NRPN:
+      engine.nrpn(ev.channel, ev.data1, (ev.data2 << 7) | ev.data3);
+      break;
+    case SynthEvent::PATTERN: {
+      StepSequencer::Pattern pattern;
+      if (patternQueue.pop(pattern)) engine.setPattern(pattern);
+      break;
+    }
+    case SynthEvent::SEQUENCER:
+      applySequencerCommand(ev.data1, (ev.data2 << 7) | ev.data3);
+      break;
+  }
+}
+
+/**
+ * @brief Sends livePatch as one SysEx patch dump (core 0).
+ * F0 7D 07 <delay sync bits> <count> (<cc> <value>) x count F7
+ */
+void sendPatchDump() {
+  uint8_t msg[5 + 2 * Patch::kCcCount + 1];
+  uint8_t* p = msg;
+  *p++ = 0xF0;
+  *p++ = SYSEX_MANUFACTURER_ID;
+  *p++ = SYSEX_PATCH_DUMP;
+  *p++ = livePatch.delaySync;
+  *p++ = Patch::kCcCount;
+  for (int i = 0; i < Patch::kCcCount; i++) {
+    *p++ = Patch::kCcs[i];
+    *p++ = livePatch.values[i];
+  }
+  *p++ = 0xF7;
+  MIDI.sendSysEx(p - msg, msg, true);
+}
+
+/**
+ * @brief Makes a patch the current sound (core 0).
+ * Updates the UI, then hands the patch to the audio core, which applies all
+ * of it at the start of a block; the parameter smoothing glides the levels
+ * and the filter to their new values.
+ */
+void loadPatch(const Patch& patch) {
+  livePatch = patch;
 #ifdef ENABLE_UI
-volatile bool midiNeedsDisplayUpdate = false;
+  for (int i = 0; i < Patch::kCcCount; i++) {
+    if (uiManager.updateParameterValue(Patch::kCcs[i], patch.values[i])) midiNeedsDisplayUpdate = true;
+  }
+#endif
+
+  while (!patchQueue.push(patch)) {
+    tight_loop_contents();
+  }
+  postEvent(SynthEvent::PATCH, 0, 0, 0);
+}
+
+/**
+ * @brief Applies a step sequencer command on the audio core.
+ * @param command SynthEvent::SeqCommand
+ * @param value Command value (sync mode, tempo in 1/10 BPM)
+ */
+void applySequencerCommand(uint8_t command, uint16_t value) {
+  switch (command) {
+    case SynthEvent::SEQ_STOP:  engine.stopSequencer(); break;
+    case SynthEvent::SEQ_START: engine.startSequencer(); break;
+    case SynthEvent::SEQ_SYNC:
+      engine.setSequencerSync(value ? StepSequencer::MIDI_CLOCK : StepSequencer::INTERNAL);
+      break;
+    case SynthEvent::SEQ_TEMPO: engine.setSequencerTempo(value * 0.1f); break;
+  }
+}
 
-// Mutex for synchronizing parameter changes between cores (or interrupts)
-auto_init_mutex(paramMutex);
+/**
+ * @brief Recalls a preset slot (core 0) and sends it to the web controller
+ * as a patch dump.
+ * @return false if the slot is empty
+ */
+bool recallPreset(int slot) {
+  Patch patch;
+  if (!presetStore.load(slot, patch)) return false;
+  loadPatch(patch);
+  sendPatchDump();
+  return true;
+}
+
+/**
+ * @brief Saves the current sound to a preset slot (core 0).
+ * The flash erase parks the audio core, so the output drops out for it.
+ */
+bool storePreset(int slot) {
+#ifdef I2S_ZERO_COPY
+  i2sOut.pause();
+#endif
+  bool ok = presetStore.store(slot, livePatch);
+#ifdef I2S_ZERO_COPY
+  i2sOut.resume();
 #endif
+  DEBUG_PRINTF("Preset %d %s\n", slot, ok ? "stored" : "not stored");
+  return ok;
+}
+
 
 // ---- DMA Audio Block Processing ----
-#define AUDIO_BLOCK_SIZE 256  // samples per stereo frame (larger = more CPU headroom)
-int16_t audioBuffer[AUDIO_BLOCK_SIZE * 2];  // L/R interleaved
+#ifndef I2S_ZERO_COPY
+alignas(4) int16_t audioBuffer[AUDIO_BLOCK_SIZE * 2];  // L/R interleaved (packed 32-bit frames), blockFrames at most
+#endif
+
+// Duration of one block. Events are rendered exactly one block after they
+// arrive: an event from the window [blockStart - blockMicros, blockStart) lands
+// at its matching sample offset, trading a constant delay for zero jitter.
+// Set from audioConfig in setup1().
+uint32_t blockMicros = 0;
 
 /**
- * @brief DMA transmit complete callback (currently unused but available for monitoring)
+ * @brief DMA transmit complete callback (core 1, interrupt context).
+ * Counts underflows: the DMA ran out of written blocks and played silence.
  */
-void onI2STransmit() {
-  // Could set a flag here for debugging underruns
+void SYNTH_RAM_FUNC(onI2STransmit)() {
+#ifdef I2S_ZERO_COPY
+  if (i2sOut.getUnderflow()) {
+#else
+  if (i2sOut.getOverUnderflow()) {
+#endif
+    audioMonitor.underrun();
+  }
 }
 
 /**
- * @brief Fill audio buffer with processed samples
- * Generates AUDIO_BLOCK_SIZE stereo samples into the buffer.
- */
-void fillAudioBlock() {
-  for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
-    // Process single sample
-    float envAmpOut = envAmp.process();
-    float envFiltOut = envFilt.process();
-    float rawSample = osc.process();
-    float filtered = filter.process(rawSample, envFiltOut, lastNoteWasAccented ? 1.0f : 0.0f);
-    
-    // Remove DC offset caused by resonant filter *before* VCA/Distortion
-    filtered = hpfPostFilter.processHPF(filtered);
-    
-    // VCA Mixing (Open303 Style)
-    float vcaMod = envAmpOut;
-    if (envAmp.isActive()) {
-        vcaMod += 0.45f * envFiltOut;
-        vcaMod += currentAccentGain * 3.0f * envFiltOut;
-    }
-    
-    // Smooth the VCA signal to remove clicks
-    vcaMod = ampDeClicker.process(vcaMod);
-    
-    // Apply VCA *before* Distortion
-    float vcaOutput = filtered * vcaMod;
+ * @brief Logs an effect arena's budget and reservations (debug builds).
+ */
+void printArena(const char* name, const EffectArena& arena) {
+  if (!arena.capacity()) return;
+  DEBUG_PRINTF("%s arena: %u of %u bytes\n", name, (unsigned)arena.bytesUsed(), (unsigned)arena.capacity());
+  for (int i = 0; i < arena.allocationCount(); i++) {
+    DEBUG_PRINTF("  %-16s %u\n", arena.allocation(i).owner, (unsigned)arena.allocation(i).bytes);
+  }
+}
 
-    // Apply Distortion (Post-VCA)
-    float distorted = distFx.process(vcaOutput);
-    
-    float sample = distorted * volume;
-    float dryL = sample;
-    float dryR = sample;
+/**
+ * @brief Renders frames [start, end) of the current block.
+ */
+void SYNTH_RAM_FUNC(renderFrames)(int16_t* block, int start, int end) {
+  if (end > start) {
+    engine.render(&block[start * 2], end - start);
+  }
+}
+
+/**
+ * @brief Fill audio buffer with processed samples
+ * Generates audioConfig.blockFrames stereo samples into block, splitting the
+ * block at the sample offset of each queued event so notes and CCs land on
+ * the sample that matches their arrival time.
+ */
+void SYNTH_RAM_FUNC(fillAudioBlock)(int16_t* block) {
+  const uint32_t blockStart = micros();
+  const uint32_t windowStart = blockStart - blockMicros;
+  const int frames = audioConfig.blockFrames;
+  const float samplesPerMicro = audioConfig.sampleRate * 1.0e-6f;
 
-    float outL = stereoDelay.processL(dryL);
-    float outR = stereoDelay.processR(dryR);
-    stereoDelay.tick(dryL, dryR);
+  int pos = 0;
+  SynthEvent ev;
+  while (eventQueue.peek(ev)) {
+    int32_t age = (int32_t)(ev.timestamp - windowStart);
+    if (age >= (int32_t)blockMicros) break;  // Arrived after this window, next block
 
-    // Soft Clipper on final output
-    float finalL = std::tanh(outL * 0.10f) * 30000.0f;
-    float finalR = std::tanh(outR * 0.10f) * 30000.0f;
+    int offset = (age <= 0) ? 0 : (int)(age * samplesPerMicro);
+    offset = std::clamp(offset, pos, frames - 1);  // Keep queue order
+    if (ev.type == SynthEvent::PATCH && offset > 0) break;  // Presets switch at a block start
 
-    // Store in interleaved stereo buffer
-    audioBuffer[i * 2] = (int16_t)finalL;
-    audioBuffer[i * 2 + 1] = (int16_t)finalR;
+    renderFrames(block, pos, offset);
+    pos = offset;
+    applyEvent(ev);
+#ifdef LATENCY_PROBE
+    if (ev.type == SynthEvent::NOTE_ON) {
+      latencyProbe.applied(ev.timestamp, offset);
+#if defined(I2S_ZERO_COPY) && defined(LATENCY_PULSE_PIN)
+      i2sOut.mark(offset);
+#endif
+    }
+#endif
+    eventQueue.drop();
   }
+  renderFrames(block, pos, frames);
 }
 
 #ifdef ENABLE_UI
 /**
  * @brief Callback for UI parameter changes
- * Routes encoder changes to the internal MIDI CC handler
- * AND sends MIDI CC out over USB so web controller can receive
+ * Queues encoder changes for the audio core AND for a MIDI CC out over USB so
+ * web controller can receive. Both are coalesced (see flushParameterChanges()),
+ * so a fast sweep sends its latest value instead of every detent.
  */
 void onParameterChange(uint8_t cc, uint8_t value) {
-  // Send CC out over USB MIDI so web controller updates
-  MIDI.sendControlChange(cc, value, 1);
-  
-  // Also apply the change locally
-  if (mutex_try_enter(&paramMutex, nullptr)) {
-    handleControlChange(1, cc, value);
-    mutex_exit(&paramMutex);
-  }
+  livePatch.setCc(cc, value);
+  ccApply.set(cc, value);
+  ccEcho.set(cc, value);
+}
+
+/**
+ * @brief Passes the coalesced encoder changes on (core 0, every loop()).
+ * Applies them at most every CC_APPLY_INTERVAL_US and echoes them at most
+ * every CC_ECHO_INTERVAL_US.
+ */
+void flushParameterChanges() {
+  const uint32_t now = micros();
+  ccApply.flush(now, [](uint8_t cc, uint8_t value) {
+    postEvent(SynthEvent::CONTROL_CHANGE, 1, cc, value);
+  });
+  ccEcho.flush(now, [](uint8_t cc, uint8_t value) {
+    MIDI.sendControlChange(cc, value, 1);
+  });
 }
 #endif
 
 /**
- * @brief Arduino Setup function.
- * Initializes pins, Serial, I2S, MIDI, and synthesis objects.
+ * @brief Arduino Setup function (core 0).
+ * Initializes pins, Serial, MIDI, the core handoff queue and the UI.
  */
 void setup() {
   // USB Device Name configuration
@@ -239,49 +491,21 @@ void setup() {
   DEBUG_BEGIN(115200);
   DEBUG_PRINTLN("PICO-303 Synth Starting");
 
-  // I2S setup
-  i2sOut.setBitsPerSample(16);
-  // Large buffers for adequate headroom (8 buffers of 256 words = ~46ms total)
-  i2sOut.setBuffers(8, 256);
-  i2sOut.onTransmit(onI2STransmit);  // Optional DMA callback
-  if (!i2sOut.begin(sampleRate)) {
-    DEBUG_PRINTLN("I2S init failed");
-    while (1);
-  }
-
   // MIDI setup
   MIDI.setHandleNoteOn(handleNoteOn);
   MIDI.setHandleNoteOff(handleNoteOff);
   MIDI.setHandleControlChange(handleControlChange);
   MIDI.begin(MIDI_CHANNEL_OMNI);
   MIDI.setHandleClock(handleClock);
+  MIDI.setHandleStart(handleStart);
+  MIDI.setHandleContinue(handleContinue);
+  MIDI.setHandleStop(handleStop);
+  MIDI.setHandleSongPosition(handleSongPosition);
+  MIDI.setHandleSystemExclusive(handleSysEx);
+  MIDI.setHandleProgramChange(handleProgramChange);
+  presetStore.begin();
+  controlCoreReady = true;
 
-  // Osc
-  osc.setSampleRate(sampleRate);
-  osc.setWaveform(Oscillator::SQUARE);
-  osc.setMode(true); // Enable JC303 mode (Square = Pulse 53%)
-  envAmp.setDecay(300.0f);    // 300ms
-  envAmp.setRelease(10.0f);   // 10ms
-  envFilt.setDecayTime(1000.0f); // 1000ms
-
-  filter.setCutoff(1000.0f);
-  filter.setResonance(0.0f);
-  filter.setEnvMod(500.0f);      // how much the envelope modulates cutoff
-
-  if (!stereoDelay.begin()) {
-    DEBUG_PRINTLN("ERROR: Failed to allocate delay buffer!");
-  }
-  stereoDelay.setTimeSamplesL(11025); 
-  stereoDelay.setTimeSamplesR(11025); 
-
-  // Let's use 2.0ms to be safe and smooth.
-  ampDeClicker.setSampleRate(sampleRate);
-  ampDeClicker.setTimeConstant(2.0f); 
-  
-  // Post-filter HPF to remove DC offset (crucial for distortion)
-  hpfPostFilter.setSampleRate(sampleRate);
-  hpfPostFilter.setCutoff(30.0f); // ~25-30Hz like Open303
-  
   // UI setup
 #ifdef ENABLE_UI
   uiManager.begin(ENCODER_A_PIN, ENCODER_B_PIN, ENCODER_SW_PIN);
@@ -297,16 +521,170 @@ void setup() {
   }
 #endif
   
-  // Core 1 is unused in this single-core implementation
-  DEBUG_PRINTLN("Setup complete - Single Core Mode");
+  DEBUG_PRINTLN("Setup complete - Dual Core Mode (core 0: MIDI/UI)");
+}
+
+/**
+ * @brief Audio core setup (core 1).
+ * Initializes the synthesis objects and I2S. I2S is started from this core
+ * so its DMA interrupt is serviced here, away from USB and I2C traffic.
+ */
+void setup1() {
+  while (!controlCoreReady) {
+    tight_loop_contents();
+  }
+
+  audioConfig.blockFrames = std::clamp(audioConfig.blockFrames, 1, AUDIO_BLOCK_SIZE);
+  const int sampleRate = audioConfig.sampleRate;
+  const int blockFrames = audioConfig.blockFrames;
+  blockMicros = (uint32_t)(blockFrames * 1000000ULL / sampleRate);
+
+#if defined(RP2350_PSRAM_CS)
+  // Long delay line in PSRAM, accessed in block batches (see StereoDelay)
+  const size_t psramBytes = EFFECT_PSRAM_KB * 1024u;
+  if (rp2040.getPSRAMSize() >= psramBytes) {
+    void* psram = pmalloc(psramBytes);
+    if (psram) {
+      EffectArena::psram().begin(psram, psramBytes, true);
+      audioConfig.maxDelayMs = AUDIO_PSRAM_DELAY_MS;
+    }
+  }
+  if (!EffectArena::psram().capacity()) {
+    // No PSRAM after all: the line has to fit the small SRAM arena
+    audioConfig.maxDelayMs = std::min(audioConfig.maxDelayMs,
+      StereoDelay::maxDelayMsFor(EffectArena::sram().capacity(), (float)sampleRate));
+  }
+#endif
+
+  // Time both kernel sets on this core before audio starts. This runs before
+  // engine.begin(): the bench's scratch delay line borrows the SRAM arena
+  // space the engine's line takes next, and hands it back
+  uint32_t ticksPerSecond = profileClockBegin();
+  KernelBench kernelBench;
+  const bool benchOk = kernelBench.run(profileTicks, sampleRate);
+  if (!benchOk) {
+    DEBUG_PRINTLN("KernelBench skipped: no scratch space in the SRAM arena");
+  }
+
+  if (!engine.begin(audioConfig)) {
+    DEBUG_PRINTLN("ERROR: Failed to allocate delay buffer!");
+  }
+  printArena("SRAM", EffectArena::sram());
+  printArena("PSRAM", EffectArena::psram());
+
+  if (benchOk) {
+#if DEBUG_SERIAL
+    for (int k = 0; k < KernelBench::KERNEL_COUNT; k++) {
+      KernelBench::Kernel kernel = (KernelBench::Kernel)k;
+      DEBUG_PRINTF("Kernel %-8s float %lu, fixed %lu ticks/block\n", KernelBench::kernelName(kernel),
+                   (unsigned long)kernelBench.ticks(kernel, SynthEngine::KERNELS_FLOAT),
+                   (unsigned long)kernelBench.ticks(kernel, SynthEngine::KERNELS_FIXED));
+    }
+#if OSCILLATOR_WAVETABLE_SUPPORT
+    DEBUG_PRINTF("Kernel %-8s float %lu, fixed %lu ticks/block\n", "wavetbl",
+                 (unsigned long)kernelBench.wavetableTicks(SynthEngine::KERNELS_FLOAT),
+                 (unsigned long)kernelBench.wavetableTicks(SynthEngine::KERNELS_FIXED));
+#endif
+#endif
+#ifdef KERNEL_AUTOSELECT
+    engine.setKernelSet(kernelBench.fastest());
+#endif
+  }
+
+  // Per-block and per-stage timing on this core's profile clock
+  engine.setProfileClock(profileTicks);
+#ifdef LATENCY_PROBE
+  latencyProbe.setSampleRate(sampleRate);
+#endif
+  audioMonitor.begin((uint32_t)((uint64_t)ticksPerSecond * blockFrames / sampleRate),
+                     audioConfig.bufferCount * blockFrames * 4);
+
+  DEBUG_PRINTF("Kernel set: %s\n", KernelBench::setName(engine.getKernelSet()));
+  DEBUG_PRINTF("Audio: %d Hz, %d x %d frames, delay %d ms\n", sampleRate, audioConfig.bufferCount,
+               blockFrames, audioConfig.maxDelayMs);
+
+  engine.setVoiceCount(VOICE_COUNT);
+  engine.setVoiceSharing(VOICE_COUNT > 1);
+  DEBUG_PRINTF("Voices: %d\n", engine.getVoiceCount());
+
+  // I2S setup
+#ifdef I2S_ZERO_COPY
+  // The engine renders into the ring's DMA blocks (default 4 of 256 frames = ~23ms)
+  i2sOut.onTransmit(onI2STransmit);
+#if defined(LATENCY_PROBE) && defined(LATENCY_PULSE_PIN)
+  i2sOut.setMarkerPin(LATENCY_PULSE_PIN);
+#endif
+  if (!i2sOut.begin(sampleRate, pBCLK, pDOUT, blockFrames, audioConfig.bufferCount)) {
+#else
+  i2sOut.setBitsPerSample(16);
+  // One DMA buffer per audio block (default 8 buffers of 256 words = ~46ms total)
+  i2sOut.setBuffers(audioConfig.bufferCount, blockFrames);
+  i2sOut.onTransmit(onI2STransmit);  // Optional DMA callback
+  if (!i2sOut.begin(sampleRate)) {
+#endif
+    DEBUG_PRINTLN("I2S init failed");
+    while (1);
+  }
+
+  DEBUG_PRINTLN("Audio core running");
+}
+
+/**
+ * @brief Audio loop (core 1).
+ * Fills the I2S buffer whenever there's space for a full block. Queued
+ * note/parameter events are applied inside fillAudioBlock() at their sample offset.
+ * With I2S_ZERO_COPY the block is rendered in place in the DMA ring, and the
+ * core sleeps until the DMA interrupt frees the next one.
+ */
+void SYNTH_RAM_FUNC(loop1)() {
+#ifdef I2S_ZERO_COPY
+  int16_t* block = i2sOut.acquire();
+  if (!block) {
+    __wfe();  // Woken by the DMA interrupt
+    return;
+  }
+  audioMonitor.noteFree(i2sOut.freeBlocks() * audioConfig.blockFrames * 4);
+#ifdef LATENCY_PROBE
+  latencyProbe.beginBlock(micros(), i2sOut.queuedFrames());
+#endif
+
+  uint32_t t0 = profileTicks();
+  fillAudioBlock(block);
+  audioMonitor.blockDone(profileTicks() - t0, engine.getStageTicks());
+  engine.resetStageTicks();
+
+  i2sOut.commit();
+#else
+  // availableForWrite() returns bytes, our block is blockFrames * 4 bytes
+  const int blockBytes = audioConfig.blockFrames * 4;
+  int freeBytes = i2sOut.availableForWrite();
+  if (freeBytes >= blockBytes) {
+    audioMonitor.noteFree(freeBytes);
+#ifdef LATENCY_PROBE
+    // Counts the buffer playing now as full: up to one block high
+    latencyProbe.beginBlock(micros(), (audioConfig.bufferCount * blockBytes - freeBytes) / 4);
+#endif
+
+    uint32_t t0 = profileTicks();
+    fillAudioBlock(audioBuffer);
+    audioMonitor.blockDone(profileTicks() - t0, engine.getStageTicks());
+    engine.resetStageTicks();
+
+    i2sOut.write((const uint8_t*)audioBuffer, blockBytes);
+  }
+#endif
 }
 
 /**
- * @brief Main execution loop.
- * Uses block-based audio processing for efficiency.
- * Fills I2S buffer whenever there's enough space, then handles UI.
+ * @brief Main execution loop (core 0).
+ * Handles MIDI input and the UI. Audio rendering runs on core 1 (loop1),
+ * so slow I2C display updates here can no longer starve the I2S buffers.
+ * It also renders shared voice jobs; core 1 takes a job back if this loop is busy.
  */
 void loop() {
+  // Render the voices core 1 offered for the current block, if any
+  engine.runVoiceJob();
+
   // Handle MIDI continuously
   MIDI.read();
 
@@ -314,22 +692,54 @@ void loop() {
   if (millis() > ledOnUntil) {
     digitalWrite(LED_PIN, LOW);
   }
-  
-  // --- Block-Based Audio Processing ---
-  // Fill I2S buffer whenever there's space for a full block
-  // availableForWrite() returns bytes, our block is AUDIO_BLOCK_SIZE * 4 bytes
-  while (i2sOut.availableForWrite() >= AUDIO_BLOCK_SIZE * 4) {
-    fillAudioBlock();
-    i2sOut.write((const uint8_t*)audioBuffer, AUDIO_BLOCK_SIZE * 4);
+
+  // Statistics push (SYSEX_STATS_PUSH)
+  static uint32_t lastStatsPush = 0;
+  if (statsPushMs && millis() - lastStatsPush >= statsPushMs) {
+    lastStatsPush = millis();
+    sendStats();
+#ifdef LATENCY_PROBE
+    sendLatencyReport();
+#endif
   }
 
+#if DEBUG_SERIAL
+  // The engine's MIDI clock tempo, followed here so core 1 never prints
+  static float loggedBpm = 0.0f;
+  const float bpm = engine.getBpm();
+  if (std::abs(bpm - loggedBpm) > 0.01f * loggedBpm) {
+    loggedBpm = bpm;
+    DEBUG_PRINTF("MIDI Clock BPM: %.2f\n", bpm);
+  }
+#endif
+
+#if defined(LATENCY_PROBE) && DEBUG_SERIAL
+  static uint32_t lastLatencyReport = 0;
+  if (millis() - lastLatencyReport >= LATENCY_REPORT_MS) {
+    lastLatencyReport = millis();
+    printLatencyReport();
+  }
+#endif
+
   // --- UI Update ---
-  // Runs between audio block fills
 #ifdef ENABLE_UI
   static uint32_t lastUiCheck = 0;
   static bool uiNeedsRedraw = false;
   static uint32_t lastDisplayUpdate = 0;
 
+#ifdef SHOW_AUDIO_LOAD
+  // Refresh the load readout once a second
+  static uint32_t lastLoadUpdate = 0;
+  if (millis() - lastLoadUpdate >= 1000) {
+    lastLoadUpdate = millis();
+    AudioMonitor::Snapshot stats;
+    audioMonitor.read(stats);
+    displayManager.setLoadInfo(AudioMonitor::toPermille(stats.avgBlockTicks, stats.budgetTicks),
+                               stats.underruns);
+    if (uiManager.getState() == UI_MENU) uiNeedsRedraw = true;
+  }
+#endif
+
   // Check UI every 5ms
   if (millis() - lastUiCheck > 5) {
     lastUiCheck = millis();
@@ -340,8 +750,8 @@ void loop() {
       midiNeedsDisplayUpdate = false;
     }
 
-    // Update display (slow I2C) - throttled to 200ms
-    if (uiNeedsRedraw && (millis() - lastDisplayUpdate >= 200)) {
+    // Redraw the framebuffer (RAM only), at most every DISPLAY_REFRESH_MS
+    if (uiNeedsRedraw && (millis() - lastDisplayUpdate >= DISPLAY_REFRESH_MS)) {
       lastDisplayUpdate = millis();
       uiNeedsRedraw = false;
       
@@ -353,278 +763,296 @@ void loop() {
       }
     }
   }
+
+  flushParameterChanges();
+
+  // Push changed bytes to the OLED, a few small I2C chunks per iteration
+  displayManager.update();
 #endif
 }
 
-// ---- MIDI handlers ----
+// ---- MIDI handlers (core 0) ----
 
 /**
  * @brief Handles MIDI Note On events.
- * Triggers envelopes, sets frequency, and handles accent/slide logic.
+ * Forwards the note to the audio core.
  * 
  * @param channel MIDI channel (1-16)
  * @param pitch MIDI note number (0-127)
  * @param velocity Note velocity (0-127)
  */
 void handleNoteOn(byte channel, byte pitch, byte velocity) {
-  bool slide = (prev_note != 0xFF);
-  bool accent = (velocity >= 100);
-
-  // Modified‑Naive overlap counter
-  if (prev_note == pitch) noteOverlap++;
-  prev_note = pitch;
-
-  // Blink LED
-  digitalWrite(LED_PIN, HIGH);
-  ledOnUntil = millis() + 20;
-
-  float freq = 440.0f * powf(2.0f, (pitch + pitchOffset - 69) / 12.0f);
-  osc.glideTo(freq, slide ? glideTimeMs : 0.0f);  // use configurable glide time
-
-  // Accent and envelope logic
-  if (!slide || accent) {
-    if (!slide) {
-      osc.resetPhase();
-    }
-    envAmp.setRelease(accent ? 50.0f : 10.0f);
-    envAmp.noteOn();
-    
-    // Use user-set decay time for normal notes, fixed 200ms for accent (TB-303 behavior)
-    envFilt.setDecayTime(accent ? 200.0f : userDecayTime);
-    envFilt.trigger();
-    
-    // Calculate accent gain for this note
-    currentAccentGain = accent ? accentLevel : 0.0f;
-    
-    // Filter modulation
-    // Base mod + Accent mod
-    // If accentLevel is 1.0, we want max boost (e.g. 2.5x total or similar)
-    // Old logic: accentBoost 1.0..2.5
-    // New logic: 1.0 + accentLevel * 1.5
-    float boost = 1.0f + currentAccentGain * 1.5f;
-    float modAmt = globalEnvMod * boost;
-    
-    modAmt = std::min(modAmt, 3000.0f);  // cap to prevent filter overload
-    filter.setEnvMod(modAmt);
-  }
-
-  lastNoteWasAccented = accent;
-
-  DEBUG_PRINTF("NoteON ch%u pitch%u vel%u slide=%d accent=%d\n",
-                channel, pitch, velocity, slide, accent);
+  postEvent(SynthEvent::NOTE_ON, channel, pitch, velocity);
+  DEBUG_PRINTF("NoteON ch%u pitch%u vel%u\n", channel, pitch, velocity);
 }
 
 /**
  * @brief Handles MIDI Note Off events.
- * Manages note overlap for legato playing and triggers release phase.
+ * Forwards the note to the audio core.
  * 
  * @param channel MIDI channel
  * @param pitch MIDI note number
  * @param velocity Release velocity
  */
 void handleNoteOff(byte channel, byte pitch, byte velocity) {
-  // Modified‑Naive: decrement overlap before noteOff
-  if (prev_note == pitch) {
-    if (noteOverlap > 0) {
-      noteOverlap--;
-      return;
-    }
-    // If no overlap left, stop tone
-    prev_note = 0xFF;
-    envAmp.noteOff();
-
-    digitalWrite(LED_PIN, HIGH);
-    ledOnUntil = millis() + 20;
-
-    DEBUG_PRINTF("NoteOFF ch%u pitch%u vel%u\n",
-                  channel, pitch, velocity);
-  }
+  postEvent(SynthEvent::NOTE_OFF, channel, pitch, velocity);
+  DEBUG_PRINTF("NoteOFF ch%u pitch%u vel%u\n", channel, pitch, velocity);
 }
 
 /**
  * @brief Handles MIDI Control Change events.
- * Updates synth parameters based on CC messages.
+ * Syncs the UI and forwards the change to the audio core.
  * 
  * @param channel MIDI channel
  * @param cc Control Change number
  * @param value Control value (0-127)
  */
 void handleControlChange(byte channel, byte cc, byte value) {
-  // Sync parameter value with UI (so encoder displays current value)
+  if (handleNrpn(channel, cc, value)) return;
+
   // Sync parameter value with UI (so encoder displays current value)
 #ifdef ENABLE_UI
-  uiManager.updateParameterValue(cc, value);
-  // Trigger display update so OLED shows the new value
-  midiNeedsDisplayUpdate = true;
-#endif
-  if (cc == 7) {  // Volume
-    // Rescale volume: Max (127) = 0.6 (safe level)
-    volume = (value / 127.0f) * 0.6f;
-    DEBUG_PRINTF("CC7 Volume: %.2f\n", volume);
-  }
-  else if (cc == 14) {  // Sub oscillator blend
-    float subAmt = value / 127.0f;
-    osc.setSubBlend(subAmt);
-    DEBUG_PRINTF("CC14 Sub Blend: %.2f\n", subAmt);
-  }
-  else if (cc == 15) {  // Accent intensity
-    accentLevel = value / 127.0f; // 0.0 to 1.0
-    DEBUG_PRINTF("CC15 Accent Level: %.2f\n", accentLevel);
-  }
-  else if (cc == 16) {  // Pitch offset
-    pitchOffset = (value - 64) / 64.0f * 12.0f; // ±12 semitones
-    DEBUG_PRINTF("CC16 Pitch Offset: %.2f semitones\n", pitchOffset);
-  }
-  else if (cc == 17) {  // Mod envelope amount
-    globalEnvMod = (value / 127.0f) * 3000.0f;  // reduced to avoid filter instability
-    DEBUG_PRINTF("CC17 Env Mod: %.1f\n", globalEnvMod);
-  }
-  else if (cc == 18) {  // Waveform blend
-    float blendVal = value / 127.0f;
-    osc.setBlend(blendVal);
-    DEBUG_PRINTF("CC18 Waveform Blend: %.2f\n", blendVal);
-  }
-  else if (cc == 71) {  // Resonance
-    float res = value / 127.0f;
-    float shaped = powf(res, 0.8f);  // slightly aggressive but safe shaping
-    filter.setResonance(std::min(shaped, 1.0f));  // ensure cap
-    DEBUG_PRINTF("CC71 Resonance: %.2f (shaped: %.2f)\n", res, shaped);
-  }
-  else if (cc == 74) {  // Filter Cutoff
-    // Exponential mapping: 300Hz to 3000Hz
-    // freq = min * (max/min)^(val/127)
-    float freq = 300.0f * pow(3000.0f / 300.0f, value / 127.0f);
-    filter.setCutoff(freq);
-    DEBUG_PRINTF("CC74 Cutoff: %.1f Hz\n", freq);
-  }
-  else if (cc == 75) {  // Envelope decay time
-    userDecayTime = 50.0f + (value / 127.0f) * 1950.0f; // 50ms to 2000ms
-    envFilt.setDecayTime(userDecayTime); // Update immediately
-    DEBUG_PRINTF("CC75 Decay Time: %.2f ms\n", userDecayTime);
-  }
-  else if (cc == 77) {  // Distortion mode
-    distFx.setType(static_cast<Distortion::Type>(value % 5));
-    DEBUG_PRINTF("CC77 Dist Mode: %d\n", value % 5);
-  }
-  else if (cc == 78) {  // Distortion amount
-    float amt = value / 127.0f;
-    distFx.setAmount(amt);
-    DEBUG_PRINTF("CC78 Dist Amount: %.2f\n", amt);
-  }
-  else if (cc == 79) {  // Distortion Mix
-    float mix = value / 127.0f;
-    distFx.setMix(mix);
-    DEBUG_PRINTF("CC79 Dist Mix: %.2f\n", mix);
-  }
-  else if (cc == 80) {  // Distortion On/Off
-    bool on = value > 63;
-    distFx.setEnabled(on);
-    DEBUG_PRINTF("CC80 Dist Enable: %d\n", on);
-  }
-  else if (cc == 81) {  // Delay Time
-    delayTimeSamplesL = map(value, 0, 127, 2000, 44100);  // 2ms to 1s
-    delayTimeSamplesR = delayTimeSamplesL;
-    stereoDelay.setTimeSamplesL(delayTimeSamplesL);
-    stereoDelay.setTimeSamplesR(delayTimeSamplesR);
-    DEBUG_PRINTF("CC81 Delay Time: %d samples\n", delayTimeSamplesL);
-  }
-  else if (cc == 82) {  // Delay Feedback
-    delayFeedback = value / 127.0f;
-    stereoDelay.setFeedback(delayFeedback);
-    DEBUG_PRINTF("CC82 Feedback: %.2f\n", delayFeedback);
-  }
-  else if (cc == 83) {  // Delay Mix
-    delayMix = value / 127.0f;
-    stereoDelay.setMix(delayMix);
-    DEBUG_PRINTF("CC83 Mix: %.2f\n", delayMix);
-  }
-  else if (cc == 86) {
-    int div = max(1, value / 16);  // Map 0–127 to divs
-    float beats = pow(2, div - 1) / 4.0f;  // 1/16, 1/8, 1/4, etc.
-    delayTimeSamplesL = beatsToSamples(beats);
-    delayTimeSamplesR = delayTimeSamplesL;
-    stereoDelay.setTimeSamplesL(delayTimeSamplesL);
-    stereoDelay.setTimeSamplesR(delayTimeSamplesR);
-    DEBUG_PRINTF("CC86 Delay Sync Division: 1/%d beat, %d samples (BPM %.1f)\n", (int)(1.0f / beats), delayTimeSamplesL, bpm);
-  }
-  else if (cc == 91) {
-    int div = max(1, value / 16);
-    float beats = pow(2, div - 1) / 4.0f;
-    if (delayModL == 1) beats *= 1.5f;       // Dotted
-    else if (delayModL == 2) beats *= 2.0f / 3.0f; // Triplet
-    int samples = beatsToSamples(beats);
-    samples = std::clamp(samples, 1, maxDelaySamples - 1);
-    delayTimeSamplesL = samples;
-    stereoDelay.setTimeSamplesL(delayTimeSamplesL);
-    DEBUG_PRINTF("CC91 Delay L Div: 1/%d beat, %d samples\n", (int)(1.0f / beats), delayTimeSamplesL);
-  }
-  else if (cc == 92) {
-    int div = max(1, value / 16);
-    float beats = pow(2, div - 1) / 4.0f;
-    if (delayModR == 1) beats *= 1.5f;
-    else if (delayModR == 2) beats *= 2.0f / 3.0f;
-    int samples = beatsToSamples(beats);
-    samples = std::clamp(samples, 1, maxDelaySamples - 1);
-    delayTimeSamplesR = samples;
-    stereoDelay.setTimeSamplesR(delayTimeSamplesR);
-    DEBUG_PRINTF("CC92 Delay R Div: 1/%d beat, %d samples\n", (int)(1.0f / beats), delayTimeSamplesR);
-  }
-  else if (cc == 93) {  // Delay L Modifier
-    delayModL = value % 3;
-    int div = max(1, delayTimeSamplesL > 0 ? log2f((delayTimeSamplesL * 4.0f / sampleRate) / (60.0f / bpm)) + 1 : 2);
-    float beats = pow(2, div - 1) / 4.0f;
-    if (delayModL == 1) beats *= 1.5f;
-    else if (delayModL == 2) beats *= 2.0f / 3.0f;
-    int samples = beatsToSamples(beats);
-    samples = std::clamp(samples, 1, maxDelaySamples - 1);
-    delayTimeSamplesL = samples;
-    stereoDelay.setTimeSamplesL(delayTimeSamplesL);
-    DEBUG_PRINTF("CC93 Delay L Mod: %d -> %d samples\n", delayModL, delayTimeSamplesL);
-  }
-  else if (cc == 94) {  // Delay R Modifier
-    delayModR = value % 3;
-    int div = max(1, delayTimeSamplesR > 0 ? log2f((delayTimeSamplesR * 4.0f / sampleRate) / (60.0f / bpm)) + 1 : 2);
-    float beats = pow(2, div - 1) / 4.0f;
-    if (delayModR == 1) beats *= 1.5f;
-    else if (delayModR == 2) beats *= 2.0f / 3.0f;
-    int samples = beatsToSamples(beats);
-    samples = std::clamp(samples, 1, maxDelaySamples - 1);
-    delayTimeSamplesR = samples;
-    stereoDelay.setTimeSamplesR(delayTimeSamplesR);
-    DEBUG_PRINTF("CC94 Delay R Mod: %d -> %d samples\n", delayModR, delayTimeSamplesR);
-  }
-  else if (cc == 100) {  // Glide Time
-    glideTimeMs = (value == 64) ? 80.0f : (value / 127.0f) * 500.0f;
-    DEBUG_PRINTF("CC100 Glide Time: %.1f ms\n", glideTimeMs);
-  }
-}
-
-/**
- * @brief Handles MIDI Clock events.
- * Calculates BPM based on clock interval.
+  // Redraw only if the parameter on screen changed
+  if (uiManager.updateParameterValue(cc, value)) midiNeedsDisplayUpdate = true;
+#endif
+  livePatch.setCc(cc, value);
+  postEvent(SynthEvent::CONTROL_CHANGE, channel, cc, value);
+  DEBUG_PRINTF("CC%u ch%u: %u\n", cc, channel, value);
+}
+
+/**
+ * @brief Follows the NRPN controllers (CC 99/98 select, CC 6/38 data entry)
+ * and forwards each data entry to the audio core as one 14-bit event.
+ * A data entry MSB applies on its own (LSB 0); an LSB refines the last MSB.
+ *
+ * @return true if the CC was part of an NRPN
+ */
+bool handleNrpn(byte channel, byte cc, byte value) {
+  static uint16_t param[16] = { 0x3FFF, 0x3FFF, 0x3FFF, 0x3FFF, 0x3FFF, 0x3FFF, 0x3FFF, 0x3FFF,
+                                0x3FFF, 0x3FFF, 0x3FFF, 0x3FFF, 0x3FFF, 0x3FFF, 0x3FFF, 0x3FFF };
+  static uint8_t dataMsb[16] = {};
+  const int ch = (channel - 1) & 0x0F;
+
+  switch (cc) {
+    case 99: param[ch] = (param[ch] & 0x7F) | (value << 7); return true;
+    case 98: param[ch] = (param[ch] & 0x3F80) | value; return true;
+    case 6: dataMsb[ch] = value; value = 0; break;
+    case 38: break;
+    default: return false;
+  }
+  if (!SynthEngine::hasNrpn(param[ch])) return true;  // Null (7F 7F) or not one of ours
+
+  const uint8_t number = param[ch];
+  livePatch.setCc(number, dataMsb[ch]);
+#ifdef ENABLE_UI
+  if (uiManager.updateParameterValue(number, dataMsb[ch])) midiNeedsDisplayUpdate = true;
+#endif
+  pushEvent({ micros(), SynthEvent::NRPN, channel, number, dataMsb[ch], value });
+  DEBUG_PRINTF("NRPN %u ch%u: %u\n", number, channel, (dataMsb[ch] << 7) | value);
+  return true;
+}
+
+/**
+ * @brief Handles MIDI Program Change (core 0): recalls preset slot program.
+ * Empty or missing slots are ignored.
+ *
+ * @param channel MIDI channel
+ * @param program Program number (0-127)
+ */
+void handleProgramChange(byte channel, byte program) {
+  recallPreset(program);
+}
+
+/**
+ * @brief Handles MIDI Clock events (core 0).
+ * Forwards the timestamped tick to the audio core.
  */
 void handleClock() {
-  clockTickCount++;
+  postEvent(SynthEvent::CLOCK, 0, 0, 0);
+}
 
-  if (clockTickCount % 24 == 0) {  // one quarter note
-    uint32_t now = micros();
-    uint32_t interval = now - lastClockMicros;
-    lastClockMicros = now;
+/**
+ * @brief Handles MIDI Start / Continue / Stop (core 0).
+ * Queued with the ticks, so the transport changes on the right tick.
+ */
+void handleStart() {
+  postEvent(SynthEvent::START, 0, 0, 0);
+  DEBUG_PRINTLN("MIDI Start");
+}
 
-    if (interval > 0) {
-      bpm = 60.0f * 1000000.0f / (float)interval;
-      DEBUG_PRINTF("MIDI Clock BPM: %.2f\n", bpm);
-    }
+void handleContinue() {
+  postEvent(SynthEvent::CONTINUE, 0, 0, 0);
+  DEBUG_PRINTLN("MIDI Continue");
+}
+
+void handleStop() {
+  postEvent(SynthEvent::STOP, 0, 0, 0);
+  DEBUG_PRINTLN("MIDI Stop");
+}
+
+/**
+ * @brief Handles MIDI Song Position Pointer (core 0).
+ * @param beats Position in 16th notes
+ */
+void handleSongPosition(unsigned beats) {
+  postEvent(SynthEvent::SONG_POSITION, 0, beats & 0x7F, (beats >> 7) & 0x7F);
+  DEBUG_PRINTF("MIDI Song Position: %u\n", beats);
+}
+
+/**
+ * @brief Sends the audio statistics reply (core 0).
+ * F0 7D 02 followed by packed 32-bit values (see SysEx.h): blocks, underruns,
+ * average load, peak load (both 1/1000 of the block budget), peak free I2S
+ * bytes, total I2S bytes, the load of each SynthEngine::Stage in 1/1000, then
+ * the minimum load (peak - minimum = render jitter), and F7.
+ */
+void sendStats() {
+  AudioMonitor::Snapshot stats;
+  audioMonitor.read(stats);
+
+  uint8_t reply[3 + (7 + SynthEngine::STAGE_COUNT) * SYSEX_U32_BYTES + 1];
+  uint8_t* p = reply;
+  *p++ = 0xF0;
+  *p++ = SYSEX_MANUFACTURER_ID;
+  *p++ = SYSEX_STATS_REPLY;
+  p = sysexPackU32(p, stats.blocks);
+  p = sysexPackU32(p, stats.underruns);
+  p = sysexPackU32(p, AudioMonitor::toPermille(stats.avgBlockTicks, stats.budgetTicks));
+  p = sysexPackU32(p, AudioMonitor::toPermille(stats.peakBlockTicks, stats.budgetTicks));
+  p = sysexPackU32(p, stats.peakFreeBytes);
+  p = sysexPackU32(p, stats.bufferBytes);
+  for (int s = 0; s < SynthEngine::STAGE_COUNT; s++) {
+    p = sysexPackU32(p, AudioMonitor::toPermille(stats.stageTicks[s], stats.budgetTicks));
   }
+  p = sysexPackU32(p, AudioMonitor::toPermille(stats.minBlockTicks, stats.budgetTicks));
+  *p++ = 0xF7;
+  MIDI.sendSysEx(p - reply, reply, true);
 }
 
+#ifdef LATENCY_PROBE
 /**
- * @brief Converts musical beats to sample count based on current BPM.
- * 
- * @param beats Number of beats (e.g., 0.25 for 1/16th note)
- * @return int Number of samples
+ * @brief Sends the latency histograms as SysEx (core 0).
+ * F0 7D 0C followed by packed 32-bit values: note-ons measured, minimum,
+ * mean and maximum latency in µs, fewest and most frames queued, latency
+ * and jitter bin width in µs, bin count, the latency bins, the jitter bins,
+ * and F7.
+ */
+void sendLatencyReport() {
+  LatencyProbe::Report report;
+  latencyProbe.read(report);
+
+  uint8_t reply[3 + (9 + 2 * LatencyProbe::kBins) * SYSEX_U32_BYTES + 1];
+  uint8_t* p = reply;
+  *p++ = 0xF0;
+  *p++ = SYSEX_MANUFACTURER_ID;
+  *p++ = SYSEX_LATENCY_REPLY;
+  p = sysexPackU32(p, report.events);
+  p = sysexPackU32(p, report.minUs);
+  p = sysexPackU32(p, report.meanUs);
+  p = sysexPackU32(p, report.maxUs);
+  p = sysexPackU32(p, report.minQueuedFrames);
+  p = sysexPackU32(p, report.maxQueuedFrames);
+  p = sysexPackU32(p, report.latencyBinUs);
+  p = sysexPackU32(p, report.jitterBinUs);
+  p = sysexPackU32(p, LatencyProbe::kBins);
+  for (int i = 0; i < LatencyProbe::kBins; i++) p = sysexPackU32(p, report.latency[i]);
+  for (int i = 0; i < LatencyProbe::kBins; i++) p = sysexPackU32(p, report.jitter[i]);
+  *p++ = 0xF7;
+  MIDI.sendSysEx(p - reply, reply, true);
+}
+
+/**
+ * @brief Prints the latency histograms on Serial (DEBUG_SERIAL builds).
+ */
+void printLatencyReport() {
+  LatencyProbe::Report report;
+  latencyProbe.read(report);
+  DEBUG_PRINTF("Latency: %lu notes, min %lu, mean %lu, max %lu us, queued %lu-%lu frames\n",
+               (unsigned long)report.events, (unsigned long)report.minUs, (unsigned long)report.meanUs,
+               (unsigned long)report.maxUs, (unsigned long)report.minQueuedFrames,
+               (unsigned long)report.maxQueuedFrames);
+  for (int i = 0; i < LatencyProbe::kBins; i++) {
+    if (!report.latency[i] && !report.jitter[i]) continue;
+    DEBUG_PRINTF("  %6lu us: latency %lu  %6lu us: jitter %lu\n",
+                 (unsigned long)(i * report.latencyBinUs), (unsigned long)report.latency[i],
+                 (unsigned long)(i * report.jitterBinUs), (unsigned long)report.jitter[i]);
+  }
+}
+#endif
+
+/**
+ * @brief Handles incoming SysEx (core 0).
+ * F0 7D 01 F7 requests a statistics reply (see sendStats()), F0 7D 03 F7
+ * clears the peaks and F0 7D 08 <n> F7 pushes the reply every n * 100 ms.
+ * F0 7D 04 <slot> F7 recalls a preset and F0 7D 05 <slot> F7 stores the
+ * current sound in one. F0 7D 06 F7 requests a patch dump (see
+ * sendPatchDump()); a dump sent to the synth loads it as the current sound,
+ * CCs it does not list keep their values. F0 7D 09 ... F7 loads a sequencer
+ * pattern and F0 7D 0A <command> [<value MSB> <value LSB>] F7 controls the
+ * sequencer (SynthEvent::SeqCommand). In LATENCY_PROBE builds F0 7D 0B F7
+ * requests the latency histograms (see sendLatencyReport()), which the clear
+ * and the push include.
+ *
+ * @param data Complete message including F0/F7
+ * @param size Message length in bytes
  */
-int beatsToSamples(float beats) {
-  float seconds = (60.0f / bpm) * beats;
-  return (int)(seconds * sampleRate);
-}
\ No newline at end of file
+void handleSysEx(byte* data, unsigned size) {
+  if (size < 4 || data[1] != SYSEX_MANUFACTURER_ID) return;
+
+  if (data[2] == SYSEX_STATS_RESET) {
+    audioMonitor.requestReset();
+#ifdef LATENCY_PROBE
+    latencyProbe.requestReset();
+#endif
+  }
+  else if (data[2] == SYSEX_STATS_REQUEST) {
+    sendStats();
+  }
+  else if (data[2] == SYSEX_STATS_PUSH && size >= 5) {
+    statsPushMs = data[3] * 100u;
+  }
+  else if (data[2] == SYSEX_PRESET_RECALL && size >= 5) {
+    recallPreset(data[3]);
+  }
+  else if (data[2] == SYSEX_PRESET_STORE && size >= 5) {
+    storePreset(data[3]);
+  }
+  else if (data[2] == SYSEX_PATCH_REQUEST) {
+    sendPatchDump();
+  }
+  else if (data[2] == SYSEX_PATCH_DUMP && size >= 6) {
+    const unsigned count = std::min<unsigned>(data[4], (size - 6) / 2);
+    Patch patch = livePatch;
+    patch.delaySync = data[3] & 0x0F;
+    for (unsigned n = 0; n < count; n++) {
+      int i = Patch::indexOf(data[5 + 2 * n]);
+      if (i >= 0) patch.values[i] = data[6 + 2 * n] & 0x7F;
+    }
+    loadPatch(patch);
+  }
+  else if (data[2] == SYSEX_PATTERN_LOAD && size >= 6 + 2 * StepSequencer::kSteps) {
+    // <length> <channel> (<pitch> <flags>) x kSteps
+    StepSequencer::Pattern pattern;
+    pattern.length = data[3];
+    pattern.channel = data[4] ? data[4] : 1;
+    for (int i = 0; i < StepSequencer::kSteps; i++) {
+      pattern.steps[i].pitch = data[5 + 2 * i] & 0x7F;
+      pattern.steps[i].flags = data[6 + 2 * i] & 0x07;
+    }
+    while (!patternQueue.push(pattern)) {
+      tight_loop_contents();
+    }
+    postEvent(SynthEvent::PATTERN, 0, 0, 0);
+  }
+  else if (data[2] == SYSEX_SEQUENCER && size >= 5) {
+    const uint8_t msb = size >= 7 ? data[4] & 0x7F : 0;
+    const uint8_t lsb = size >= 7 ? data[5] & 0x7F : 0;
+    pushEvent({ micros(), SynthEvent::SEQUENCER, 0, data[3], msb, lsb });
+  }
+#ifdef LATENCY_PROBE
+  else if (data[2] == SYSEX_LATENCY_REQUEST) {
+    sendLatencyReport();
+    printLatencyReport();
+  }
+#endif
+}